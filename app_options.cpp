@@ -0,0 +1,187 @@
+#include "app_options.h"
+#include <iostream>
+#include <string>
+#include <algorithm>
+
+namespace {
+
+bool parse_int_arg(const std::string& flag, const char* value, int min_value, int& out) {
+    try {
+        size_t consumed = 0;
+        int parsed = std::stoi(value, &consumed);
+        if (consumed != std::string(value).size() || parsed < min_value) throw std::invalid_argument(flag);
+        out = parsed;
+        return true;
+    } catch (const std::exception&) {
+        std::cerr << "Options: " << flag << " expects an integer >= " << min_value << ", got '" << value << "'" << std::endl;
+        return false;
+    }
+}
+
+bool parse_double_arg(const std::string& flag, const char* value, double min_exclusive, double& out) {
+    try {
+        size_t consumed = 0;
+        double parsed = std::stod(value, &consumed);
+        if (consumed != std::string(value).size() || !(parsed > min_exclusive)) throw std::invalid_argument(flag);
+        out = parsed;
+        return true;
+    } catch (const std::exception&) {
+        std::cerr << "Options: " << flag << " expects a number > " << min_exclusive << ", got '" << value << "'" << std::endl;
+        return false;
+    }
+}
+
+// DEVICE[:CHANNELS], where DEVICE is a PortAudio index or "default".
+bool parse_device_spec(const char* value, CaptureDeviceSpec& spec) {
+    std::string text = value;
+    size_t colon = text.find(':');
+    std::string device_part = text.substr(0, colon);
+    bool ok = colon == std::string::npos ||
+              parse_int_arg("--device CHANNELS", text.c_str() + colon + 1, 1, spec.channels);
+    if (ok && device_part == "default") {
+        spec.device = paNoDevice;
+    } else if (ok) {
+        ok = parse_int_arg("--device DEVICE", device_part.c_str(), 0, spec.device);
+    }
+    if (!ok) std::cerr << "Options: --device expects DEVICE[:CHANNELS] (DEVICE = index or 'default'), got '" << value << "'" << std::endl;
+    return ok;
+}
+
+// Comma-separated export format names, e.g. "md,html,txt".
+bool parse_export_formats(const char* value, std::vector<std::string>& formats) {
+    std::vector<std::string> parsed;
+    std::string list = value;
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t end = std::min(list.find(',', start), list.size());
+        std::string name = list.substr(start, end - start);
+        if (!find_export_format(name)) {
+            std::cerr << "Options: --export expects a comma-separated list of";
+            for (const ExportFormat& format : export_formats()) std::cerr << " " << format.name;
+            std::cerr << ", got '" << name << "'" << std::endl;
+            return false;
+        }
+        if (std::find(parsed.begin(), parsed.end(), name) == parsed.end()) parsed.push_back(name);
+        start = end + 1;
+    }
+    formats = parsed;
+    return true;
+}
+
+} // namespace
+
+bool parse_app_options(int argc, char** argv, AppOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next_value = [&](const char*& value) {
+            if (i + 1 >= argc) {
+                std::cerr << "Options: " << arg << " requires a value." << std::endl;
+                return false;
+            }
+            value = argv[++i];
+            return true;
+        };
+        const char* value = nullptr;
+
+        if (arg == "-h" || arg == "--help") {
+            options.show_help = true;
+        } else if (arg == "--no-preview") {
+            options.show_preview = false;
+        } else if (arg == "--preview-fps") {
+            if (!next_value(value) || !parse_int_arg(arg, value, 1, options.preview_fps)) return false;
+        } else if (arg == "--silence-timeout") {
+            if (!next_value(value) || !parse_int_arg(arg, value, 0, options.silence_timeout_seconds)) return false;
+        } else if (arg == "--idle-after") {
+            if (!next_value(value) || !parse_int_arg(arg, value, 0, options.idle_after_seconds)) return false;
+        } else if (arg == "--device") {
+            CaptureDeviceSpec spec;
+            if (!next_value(value) || !parse_device_spec(value, spec)) return false;
+            options.devices.push_back(spec);
+        } else if (arg == "--list-devices") {
+            options.list_devices = true;
+        } else if (arg == "--inference-workers") {
+            if (!next_value(value) || !parse_int_arg(arg, value, 1, options.inference_workers)) return false;
+        } else if (arg == "--trace") {
+            if (!next_value(value)) return false;
+            options.trace_path = value;
+        } else if (arg == "--record") {
+            if (!next_value(value)) return false;
+            options.record_path = value;
+        } else if (arg == "--record-format") {
+            if (!next_value(value)) return false;
+            std::string format = value;
+            if (format == "s16") options.record_format = RecordedSampleFormat::Int16;
+            else if (format == "f32") options.record_format = RecordedSampleFormat::Float32;
+            else {
+                std::cerr << "Options: --record-format expects 's16' or 'f32', got '" << format << "'" << std::endl;
+                return false;
+            }
+        } else if (arg == "--replay") {
+            if (!next_value(value)) return false;
+            options.replay_path = value;
+        } else if (arg == "--cache-dir") {
+            if (!next_value(value)) return false;
+            options.cache_dir = value;
+        } else if (arg == "--cache-max-mb") {
+            if (!next_value(value) || !parse_int_arg(arg, value, 0, options.cache_max_megabytes)) return false;
+        } else if (arg == "--export") {
+            if (!next_value(value) || !parse_export_formats(value, options.export_formats)) return false;
+        } else if (arg == "--word-index") {
+            options.word_index = true;
+        } else if (arg == "--model") {
+            if (!next_value(value)) return false;
+            options.model_path = value;
+        } else if (arg == "--models-dir") {
+            if (!next_value(value)) return false;
+            options.models_dir = value;
+        } else if (arg == "--profile") {
+            if (!next_value(value)) return false;
+            options.profile_path = value;
+        } else if (arg == "--target-rtf") {
+            if (!next_value(value) || !parse_double_arg(arg, value, 0.0, options.target_rtf)) return false;
+        } else if (arg == "--calibrate") {
+            options.calibrate = true;
+        } else if (arg == "--fixtures") {
+            if (!next_value(value)) return false;
+            options.fixtures_dir = value;
+        } else if (arg == "--calibration-seconds") {
+            if (!next_value(value) || !parse_double_arg(arg, value, 0.0, options.calibration_seconds)) return false;
+        } else {
+            std::cerr << "Options: Unknown argument '" << arg << "'" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+void print_app_usage(const char* program_name) {
+    std::cout << "Usage: " << program_name << " [options]\n"
+              << "  --no-preview         Do not draw the live document preview (batch/headless runs)\n"
+              << "  --preview-fps N      Maximum preview redraws per second (default " << PR_DEFAULT_FRAMES_PER_SECOND << ")\n"
+              << "  --silence-timeout N  Exit after N seconds without speech, 0 to keep running (default " << APP_DEFAULT_SILENCE_TIMEOUT_SECONDS << ")\n"
+              << "  --idle-after N       Suspend inference after N seconds without speech, 0 to disable (default " << APP_DEFAULT_IDLE_AFTER_SECONDS << ")\n"
+              << "  --device DEV[:CH]    Capture CH channels (default 1) of device DEV (index or 'default'); repeatable.\n"
+              << "                       Every channel is transcribed into its own document.\n"
+              << "  --list-devices       Show the available input devices and exit\n"
+              << "  --inference-workers N  Concurrent decodes shared by all streams (default: one per stream, up to the core count)\n"
+              << "  --trace FILE         Record a pipeline timeline (Chrome trace JSON, open in ui.perfetto.dev);\n"
+              << "                       written at exit and whenever the process receives SIGUSR1\n"
+              << "  --record FILE        Save the audio fed to whisper (16 kHz), chunk boundaries, transcripts and\n"
+              << "                       commands to FILE for --replay; one file per stream when capturing several\n"
+              << "  --record-format F    s16 (default, compact, approximate replay) or f32 (bit-exact replay)\n"
+              << "  --replay FILE        Run a recording through the pipeline again, compare the transcripts and exit\n"
+              << "  --cache-dir DIR      Reuse whisper output for audio windows already decoded with the same model\n"
+              << "                       and settings (shared safely between concurrent runs)\n"
+              << "  --cache-max-mb N     Evict least recently used cache entries beyond N MiB, 0 for no limit (default " << TC_DEFAULT_MAX_MEGABYTES << ")\n"
+              << "  --export LIST        Formats to save the document in, comma-separated: md, html, txt (default md)\n"
+              << "  --word-index         Decode with token timestamps and save a word index next to the Markdown\n"
+              << "                       (<document>.md.idx, see voxformat_index); decoding gets slower\n"
+              << "  --model PATH         Use this model file instead of picking one from the calibration profile\n"
+              << "  --models-dir DIR     Where to look for ggml-*.bin models (default ../external/whisper.cpp/models)\n"
+              << "  --target-rtf X       Slowest real-time factor an auto-selected model may have (default " << MS_DEFAULT_TARGET_RTF << ")\n"
+              << "  --profile PATH       Calibration profile location (default " << default_profile_path() << ")\n"
+              << "  --calibrate          Benchmark every model in --models-dir on this host, save the profile and exit\n"
+              << "  --fixtures DIR       WAV files to calibrate with (default ../fixtures)\n"
+              << "  --calibration-seconds N  Audio decoded per model while calibrating (default " << MS_DEFAULT_CALIBRATION_SECONDS << ")\n"
+              << "  -h, --help           Show this help\n";
+}
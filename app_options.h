@@ -0,0 +1,52 @@
+#ifndef APP_OPTIONS_H
+#define APP_OPTIONS_H
+
+#include <string>
+#include "preview_renderer.h"
+#include "model_selector.h"
+#include "audio_capturer.h"
+#include "session_recorder.h"
+#include "transcript_cache.h"
+#include "document_exporter.h"
+#include <vector>
+
+#define APP_DEFAULT_SILENCE_TIMEOUT_SECONDS 30
+#define APP_DEFAULT_IDLE_AFTER_SECONDS 10
+
+struct AppOptions {
+    bool show_preview = true;
+    int preview_fps = PR_DEFAULT_FRAMES_PER_SECOND;
+    bool show_help = false;
+    int silence_timeout_seconds = APP_DEFAULT_SILENCE_TIMEOUT_SECONDS; // 0: never exit on silence
+    int idle_after_seconds = APP_DEFAULT_IDLE_AFTER_SECONDS;           // 0: never go idle
+
+    std::string model_path;  // explicit model, skips auto-selection
+    std::string models_dir = "../external/whisper.cpp/models";
+    std::string profile_path; // empty: default_profile_path()
+    double target_rtf = MS_DEFAULT_TARGET_RTF;
+    bool calibrate = false;
+    std::string fixtures_dir = "../fixtures";
+    double calibration_seconds = MS_DEFAULT_CALIBRATION_SECONDS;
+
+    std::vector<CaptureDeviceSpec> devices; // empty: mono from the default device
+    bool list_devices = false;
+    int inference_workers = 0;              // 0: one per stream, capped at the core count
+
+    std::string trace_path; // empty: tracing off
+
+    std::string record_path; // empty: no recording
+    RecordedSampleFormat record_format = RecordedSampleFormat::Int16;
+    std::string replay_path; // replay this recording instead of capturing
+
+    std::string cache_dir;   // empty: no transcript cache
+    int cache_max_megabytes = TC_DEFAULT_MAX_MEGABYTES;
+
+    std::vector<std::string> export_formats = {"md"}; // names from export_formats()
+    bool word_index = false; // decode with token timestamps and save <document>.md.idx
+};
+
+// Parses the command line into options. Prints the problem to std::cerr and returns false on bad input.
+bool parse_app_options(int argc, char** argv, AppOptions& options);
+void print_app_usage(const char* program_name);
+
+#endif // APP_OPTIONS_H
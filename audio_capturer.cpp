@@ -1,25 +1,23 @@
 #include "audio_capturer.h"
+#include "pipeline_trace.h"
 #include <iostream>
 #include <algorithm>
 #include <thread>
 #include <chrono>
 
-AudioCapturer::AudioCapturer(std::vector<float>& shared_buffer, std::mutex& buffer_mutex,
-                             std::condition_variable& buffer_cv, std::atomic<bool>& stop_flag)
-    : m_stream(nullptr), m_pa_err(paNoError), m_pa_initialized_by_this_instance(false),
-      m_shared_audio_buffer_ref(shared_buffer),
-      m_buffer_mutex_ref(buffer_mutex),
-      m_buffer_cv_ref(buffer_cv),
-      m_stop_flag_ref(stop_flag) {}
+AudioCapturer::AudioCapturer(SampleSink sink)
+    : m_device_specs{CaptureDeviceSpec{}}, m_pa_err(paNoError), m_pa_initialized_by_this_instance(false) {
+    m_sinks.push_back([sink = std::move(sink)](const float* samples, size_t frames, size_t) {
+        sink(samples, frames);
+    });
+}
+
+AudioCapturer::AudioCapturer(std::vector<CaptureDeviceSpec> devices, std::vector<ChannelSink> sinks)
+    : m_device_specs(std::move(devices)), m_pa_err(paNoError), m_pa_initialized_by_this_instance(false),
+      m_sinks(std::move(sinks)) {}
 
 AudioCapturer::~AudioCapturer() {
-    if (m_stream) {
-        if (is_stream_active()) {
-            Pa_StopStream(m_stream);
-        }
-        Pa_CloseStream(m_stream);
-        m_stream = nullptr;
-    }
+    close_streams();
     if (m_pa_initialized_by_this_instance) {
         Pa_Terminate();
         m_pa_initialized_by_this_instance = false;
@@ -31,21 +29,59 @@ int AudioCapturer::pa_capture_callback(const void *inputBuffer, void *outputBuff
                                        const PaStreamCallbackTimeInfo* timeInfo,
                                        PaStreamCallbackFlags statusFlags,
                                        void *userData) {
-    AudioCapturer* self = static_cast<AudioCapturer*>(userData);
-    if (self->m_stop_flag_ref.load(std::memory_order_acquire)) {
+    DeviceStream* device = static_cast<DeviceStream*>(userData);
+    AudioCapturer* self = device->owner;
+    if (self->m_stopping.load(std::memory_order_acquire)) {
         return paComplete;
     }
     if (!inputBuffer) return paContinue;
 
+#if defined(VOXFORMAT_ENABLE_TRACING)
+    uint64_t callback_start_us = 0;
+    if (PipelineTrace::enabled()) {
+        if (!device->trace_thread_ready) {
+            PipelineTrace::adopt_thread_buffer(device->trace_buffer);
+            device->trace_thread_ready = true;
+        }
+        callback_start_us = PipelineTrace::now_us();
+        // Both times are on the stream clock; their difference is how long ago the first frame
+        // was sampled. Some host APIs leave them zero, so fall back to the buffer duration.
+        double adc_age_seconds = static_cast<double>(framesPerBuffer) / AC_INPUT_SAMPLE_RATE;
+        if (timeInfo && timeInfo->currentTime > 0.0 && timeInfo->inputBufferAdcTime > 0.0) {
+            adc_age_seconds = std::max(0.0, timeInfo->currentTime - timeInfo->inputBufferAdcTime);
+        }
+        uint64_t adc_age_us = std::min(callback_start_us - 1, static_cast<uint64_t>(adc_age_seconds * 1e6));
+        PipelineTrace::set_capture_time_us(callback_start_us - adc_age_us);
+        PipelineTrace::span("adc_to_callback", "capture", callback_start_us - adc_age_us, callback_start_us);
+    }
+#endif
+
+    // Interleaved frames: channel c starts at samples[c] with a stride of the channel count.
     const float *samples = static_cast<const float *>(inputBuffer);
-    {
-        std::lock_guard<std::mutex> lock(self->m_buffer_mutex_ref);
-        self->m_shared_audio_buffer_ref.insert(self->m_shared_audio_buffer_ref.end(), samples, samples + framesPerBuffer);
+    const size_t channels = static_cast<size_t>(device->spec.channels);
+    for (size_t c = 0; c < channels; ++c) {
+        self->m_sinks[device->first_sink + c](samples + c, framesPerBuffer, channels);
     }
-    self->m_buffer_cv_ref.notify_one();
+#if defined(VOXFORMAT_ENABLE_TRACING)
+    if (callback_start_us != 0) PipelineTrace::span("capture_callback", "capture", callback_start_us, PipelineTrace::now_us());
+#endif
     return paContinue;
 }
 
+void AudioCapturer::list_input_devices() {
+    bool initialized_here = Pa_Initialize() == paNoError;
+    PaDeviceIndex count = Pa_GetDeviceCount();
+    PaDeviceIndex default_device = Pa_GetDefaultInputDevice();
+    std::cout << "Input devices:" << std::endl;
+    for (PaDeviceIndex i = 0; i < count; ++i) {
+        const PaDeviceInfo* info = Pa_GetDeviceInfo(i);
+        if (!info || info->maxInputChannels <= 0) continue;
+        std::cout << "  [" << i << "] " << info->name << " (" << info->maxInputChannels << " input channel(s))"
+                  << (i == default_device ? " [default]" : "") << std::endl;
+    }
+    if (initialized_here) Pa_Terminate();
+}
+
 bool AudioCapturer::initialize() {
     if (m_pa_initialized_by_this_instance) {
         return true;
@@ -57,75 +93,113 @@ bool AudioCapturer::initialize() {
     }
     m_pa_initialized_by_this_instance = true;
 
-    PaDeviceIndex device_idx = Pa_GetDefaultInputDevice();
-    if (device_idx == paNoDevice) {
-        std::cerr << "AudioCapturer: No default input audio device found." << std::endl;
+    size_t total_channels = 0;
+    for (const auto& spec : m_device_specs) total_channels += static_cast<size_t>(std::max(0, spec.channels));
+    if (total_channels != m_sinks.size() || total_channels == 0) {
+        std::cerr << "AudioCapturer: " << m_sinks.size() << " sink(s) supplied for " << total_channels << " channel(s)." << std::endl;
         return false;
     }
-    const PaDeviceInfo* device_info = Pa_GetDeviceInfo(device_idx);
-
-    m_input_parameters.device = device_idx;
-    m_input_parameters.channelCount = 1;
-    m_input_parameters.sampleFormat = paFloat32;
-    m_input_parameters.suggestedLatency = device_info ? device_info->defaultLowInputLatency : 0.1;
-    m_input_parameters.hostApiSpecificStreamInfo = nullptr;
-
-    m_pa_err = Pa_OpenStream(
-              &m_stream,
-              &m_input_parameters,
-              nullptr,
-              AC_INPUT_SAMPLE_RATE,
-              AC_FRAMES_PER_CALLBACK,
-              paClipOff,
-              AudioCapturer::pa_capture_callback,
-              this
-          );
 
-    if (m_pa_err != paNoError) {
-        std::cerr << "AudioCapturer: PortAudio error opening stream: " << Pa_GetErrorText(m_pa_err) << std::endl;
-        m_stream = nullptr;
-        return false;
+    size_t next_sink = 0;
+    for (const auto& spec : m_device_specs) {
+        auto device = std::make_unique<DeviceStream>();
+        device->owner = this;
+        device->spec = spec;
+        device->first_sink = next_sink;
+        next_sink += static_cast<size_t>(spec.channels);
+
+        PaDeviceIndex device_idx = spec.device == paNoDevice ? Pa_GetDefaultInputDevice() : spec.device;
+        if (device_idx == paNoDevice) {
+            std::cerr << "AudioCapturer: No default input audio device found." << std::endl;
+            return false;
+        }
+        const PaDeviceInfo* device_info = Pa_GetDeviceInfo(device_idx);
+        if (!device_info) {
+            std::cerr << "AudioCapturer: Invalid input device index " << device_idx << std::endl;
+            return false;
+        }
+        if (device_info->maxInputChannels < spec.channels) {
+            std::cerr << "AudioCapturer: Device " << device_idx << " (" << device_info->name << ") has only "
+                      << device_info->maxInputChannels << " input channel(s), " << spec.channels << " requested." << std::endl;
+            return false;
+        }
+        device->spec.device = device_idx;
+
+        device->input_parameters.device = device_idx;
+        device->input_parameters.channelCount = spec.channels;
+        device->input_parameters.sampleFormat = paFloat32;
+        device->input_parameters.suggestedLatency = device_info->defaultLowInputLatency;
+        device->input_parameters.hostApiSpecificStreamInfo = nullptr;
+
+        m_pa_err = Pa_OpenStream(
+                  &device->stream,
+                  &device->input_parameters,
+                  nullptr,
+                  AC_INPUT_SAMPLE_RATE,
+                  AC_FRAMES_PER_CALLBACK,
+                  paClipOff,
+                  AudioCapturer::pa_capture_callback,
+                  device.get()
+              );
+
+        if (m_pa_err != paNoError) {
+            std::cerr << "AudioCapturer: PortAudio error opening stream on device " << device_idx << ": " << Pa_GetErrorText(m_pa_err) << std::endl;
+            device->stream = nullptr;
+            return false;
+        }
+        m_streams.push_back(std::move(device));
     }
     return true;
 }
 
 bool AudioCapturer::start_stream() {
-    if (!m_stream) {
+    if (m_streams.empty()) {
         std::cerr << "AudioCapturer: Stream not initialized. Cannot start." << std::endl;
         return false;
     }
-    if (Pa_IsStreamActive(m_stream) > 0) {
-        return true;
-    }
-    m_pa_err = Pa_StartStream(m_stream);
-    if (m_pa_err != paNoError) {
-        std::cerr << "AudioCapturer: PortAudio error starting stream: " << Pa_GetErrorText(m_pa_err) << std::endl;
-        Pa_CloseStream(m_stream);
-        m_stream = nullptr;
-        return false;
+    m_stopping.store(false, std::memory_order_release);
+    for (auto& device : m_streams) {
+        if (Pa_IsStreamActive(device->stream) > 0) continue;
+#if defined(VOXFORMAT_ENABLE_TRACING)
+        if (!device->trace_buffer) device->trace_buffer = PipelineTrace::reserve_thread_buffer("audio-callback");
+        device->trace_thread_ready = false;
+#endif
+        m_pa_err = Pa_StartStream(device->stream);
+        if (m_pa_err != paNoError) {
+            std::cerr << "AudioCapturer: PortAudio error starting stream: " << Pa_GetErrorText(m_pa_err) << std::endl;
+            close_streams();
+            return false;
+        }
     }
     return true;
 }
 
 void AudioCapturer::stop_stream() {
-    if (m_stream && is_stream_active()) {
+    m_stopping.store(true, std::memory_order_release);
+    if (is_stream_active()) {
         std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        m_pa_err = Pa_StopStream(m_stream);
-        if (m_pa_err != paNoError && m_pa_err != paStreamIsStopped) {
-             std::cerr << "AudioCapturer Warning: Pa_StopStream reported: " << Pa_GetErrorText(m_pa_err) << std::endl;
-        }
     }
-    if (m_stream) {
-        Pa_CloseStream(m_stream);
-        m_stream = nullptr;
+    close_streams();
+}
+
+void AudioCapturer::close_streams() {
+    for (auto& device : m_streams) {
+        if (!device->stream) continue;
+        if (Pa_IsStreamActive(device->stream) > 0) {
+            m_pa_err = Pa_StopStream(device->stream);
+            if (m_pa_err != paNoError && m_pa_err != paStreamIsStopped) {
+                 std::cerr << "AudioCapturer Warning: Pa_StopStream reported: " << Pa_GetErrorText(m_pa_err) << std::endl;
+            }
+        }
+        Pa_CloseStream(device->stream);
+        device->stream = nullptr;
     }
+    m_streams.clear();
 }
 
 bool AudioCapturer::is_stream_active() const {
-    if (!m_stream) return false;
-    PaError err = Pa_IsStreamActive(m_stream);
-    if (err < 0) {
-        return false;
+    for (const auto& device : m_streams) {
+        if (device->stream && Pa_IsStreamActive(device->stream) > 0) return true;
     }
-    return err > 0;
-}
\ No newline at end of file
+    return false;
+}
@@ -3,34 +3,65 @@
 
 #include <vector>
 #include <string>
-#include <mutex>
-#include <condition_variable>
 #include <atomic>
+#include <functional>
+#include <memory>
 #include <portaudio.h>
 
+struct ThreadTraceBuffer; // pipeline_trace.h
+
 #define AC_INPUT_SAMPLE_RATE 44100
 #define AC_FRAMES_PER_CALLBACK 256
 
+// One input device to open; every channel becomes its own stream.
+struct CaptureDeviceSpec {
+    PaDeviceIndex device = paNoDevice; // paNoDevice: the default input device
+    int channels = 1;
+};
+
 class AudioCapturer {
 public:
-    AudioCapturer(std::vector<float>& shared_buffer, std::mutex& buffer_mutex,
-                  std::condition_variable& buffer_cv, std::atomic<bool>& stop_flag);
+    // Receives one channel from the PortAudio callback thread: frames samples spaced `stride`
+    // floats apart (stride == channel count). Must not block or allocate.
+    using ChannelSink = std::function<void(const float* samples, size_t frames, size_t stride)>;
+    // Mono convenience form used for a single default device.
+    using SampleSink = std::function<void(const float* samples, size_t count)>;
+
+    explicit AudioCapturer(SampleSink sink);
+    // sinks are consumed in order: all channels of devices[0], then devices[1], ...
+    AudioCapturer(std::vector<CaptureDeviceSpec> devices, std::vector<ChannelSink> sinks);
     ~AudioCapturer();
     bool initialize();
     bool start_stream();
     void stop_stream();
     bool is_stream_active() const;
 
+    size_t channel_count() const { return m_sinks.size(); }
+    // Prints the input devices PortAudio can see (index, name, input channels).
+    static void list_input_devices();
+
 private:
-    PaStream* m_stream;
-    PaStreamParameters m_input_parameters;
+    struct DeviceStream {
+        AudioCapturer* owner = nullptr;
+        CaptureDeviceSpec spec;
+        size_t first_sink = 0;
+        PaStream* stream = nullptr;
+        PaStreamParameters input_parameters{};
+        // Reserved by start_stream() and adopted by the callback thread on its first call, so
+        // tracing never allocates or locks there. Touched only by the callback once started.
+        ThreadTraceBuffer* trace_buffer = nullptr;
+        bool trace_thread_ready = false;
+    };
+
+    void close_streams();
+
+    std::vector<CaptureDeviceSpec> m_device_specs;
+    std::vector<std::unique_ptr<DeviceStream>> m_streams;
     PaError m_pa_err;
     bool m_pa_initialized_by_this_instance;
 
-    std::vector<float>& m_shared_audio_buffer_ref;
-    std::mutex& m_buffer_mutex_ref;
-    std::condition_variable& m_buffer_cv_ref;
-    std::atomic<bool>& m_stop_flag_ref;
+    std::vector<ChannelSink> m_sinks;
+    std::atomic<bool> m_stopping{false};
 
     static int pa_capture_callback(const void *inputBuffer, void *outputBuffer,
                                    unsigned long framesPerBuffer,
@@ -38,4 +69,4 @@ private:
                                    PaStreamCallbackFlags statusFlags,
                                    void *userData);
 };
-#endif // AUDIO_CAPTURER_H
\ No newline at end of file
+#endif // AUDIO_CAPTURER_H
@@ -0,0 +1,537 @@
+// bench_main.cpp - performance benchmarks for the VoxFormat engine.
+//   voxformat_bench channels --model PATH [--fixtures DIR] [--seconds S] [--max-channels N] [--workers N]
+//   voxformat_bench soak [--model PATH] [--hours H] [--samples N] [--fixtures DIR] [--cache-dir DIR] [--columns N]
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <map>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <filesystem>
+#include <streambuf>
+#if defined(_WIN32)
+#include <malloc.h> // _aligned_malloc
+#endif
+
+#include "whisper_model.h"
+#include "whisper_processor.h"
+#include "inference_pool.h"
+#include "vox_session.h"
+#include "model_selector.h"
+#include "preview_renderer.h"
+#include "document_formatter.h"
+#include "process_stats.h"
+#include "transcript_cache.h"
+
+// Allocation counters for the soak benchmark. Replacing the global operators here counts every
+// allocation in the process, library code included: plain, array, nothrow and over-aligned forms.
+static std::atomic<uint64_t> g_allocations{0};
+static std::atomic<uint64_t> g_frees{0};
+
+static void* counted_alloc(std::size_t size, std::size_t alignment) noexcept {
+    if (size == 0) size = 1;
+    void* p = nullptr;
+    if (alignment == 0) {
+        p = std::malloc(size);
+    } else {
+#if defined(_WIN32)
+        p = _aligned_malloc(size, alignment);
+#else
+        if (posix_memalign(&p, std::max(alignment, sizeof(void*)), size) != 0) p = nullptr;
+#endif
+    }
+    if (p) g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return p;
+}
+
+static void counted_free(void* p, [[maybe_unused]] bool aligned) noexcept {
+    if (!p) return;
+    g_frees.fetch_add(1, std::memory_order_relaxed);
+#if defined(_WIN32)
+    if (aligned) {
+        _aligned_free(p);
+        return;
+    }
+#endif
+    std::free(p);
+}
+
+static void* counted_alloc_or_throw(std::size_t size, std::size_t alignment) {
+    if (void* p = counted_alloc(size, alignment)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size) { return counted_alloc_or_throw(size, 0); }
+void* operator new[](std::size_t size) { return counted_alloc_or_throw(size, 0); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return counted_alloc(size, 0); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return counted_alloc(size, 0); }
+void* operator new(std::size_t size, std::align_val_t al) { return counted_alloc_or_throw(size, static_cast<std::size_t>(al)); }
+void* operator new[](std::size_t size, std::align_val_t al) { return counted_alloc_or_throw(size, static_cast<std::size_t>(al)); }
+void* operator new(std::size_t size, std::align_val_t al, const std::nothrow_t&) noexcept { return counted_alloc(size, static_cast<std::size_t>(al)); }
+void* operator new[](std::size_t size, std::align_val_t al, const std::nothrow_t&) noexcept { return counted_alloc(size, static_cast<std::size_t>(al)); }
+
+void operator delete(void* p) noexcept { counted_free(p, false); }
+void operator delete[](void* p) noexcept { counted_free(p, false); }
+void operator delete(void* p, std::size_t) noexcept { counted_free(p, false); }
+void operator delete[](void* p, std::size_t) noexcept { counted_free(p, false); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { counted_free(p, false); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { counted_free(p, false); }
+void operator delete(void* p, std::align_val_t) noexcept { counted_free(p, true); }
+void operator delete[](void* p, std::align_val_t) noexcept { counted_free(p, true); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { counted_free(p, true); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { counted_free(p, true); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { counted_free(p, true); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { counted_free(p, true); }
+
+namespace fs = std::filesystem;
+
+namespace {
+
+#define SOAK_DEFAULT_HOURS 8.0
+#define SOAK_DEFAULT_SAMPLES 16
+#define SOAK_GROWTH_EXPONENT_LIMIT 0.25  // per-chunk costs should not grow with session length
+#define SOAK_MEMORY_EXPONENT_LIMIT 1.25  // memory may grow linearly with the document, not faster
+#define SOAK_MIN_FLAGGED_RATIO 1.5       // per-chunk costs must also have grown by this much to be flagged
+
+struct BenchArgs {
+    std::map<std::string, std::string> values;
+
+    std::string get(const std::string& key, const std::string& fallback = "") const {
+        auto it = values.find(key);
+        return it == values.end() ? fallback : it->second;
+    }
+    double get_number(const std::string& key, double fallback) const {
+        auto it = values.find(key);
+        return it == values.end() ? fallback : std::stod(it->second);
+    }
+};
+
+bool parse_bench_args(int argc, char** argv, int first, BenchArgs& args) {
+    for (int i = first; i < argc; ++i) {
+        std::string key = argv[i];
+        if (key.rfind("--", 0) != 0 || i + 1 >= argc) {
+            std::cerr << "Bench: Expected --name value pairs, got '" << key << "'" << std::endl;
+            return false;
+        }
+        args.values[key.substr(2)] = argv[++i];
+    }
+    return true;
+}
+
+void print_bench_usage(const char* program_name) {
+    std::cout << "Usage: " << program_name << " channels --model PATH [--fixtures DIR] [--seconds S] [--max-channels N] [--workers N]\n"
+              << "  Decodes S seconds of fixture audio (default 30) on 1..N concurrent streams sharing one model and\n"
+              << "  worker pool, and reports how many streams this machine keeps up with in real time.\n"
+              << "       " << program_name << " soak [--model PATH] [--hours H] [--samples N] [--fixtures DIR] [--cache-dir DIR] [--columns N]\n"
+              << "  Simulates H hours of dictation (default " << SOAK_DEFAULT_HOURS << ") as fast as possible and samples memory,\n"
+              << "  allocations, per-chunk latency and preview render time N times (default " << SOAK_DEFAULT_SAMPLES << ").\n"
+              << "  With --model, looped fixture audio runs through the whole pipeline (repeats come from the transcript\n"
+              << "  cache); without it, synthetic transcripts drive the formatter and preview. Exits with 2 when a\n"
+              << "  cost grows faster than the session.\n";
+}
+
+// Feeds the same audio to every session as fast as they accept it, then waits for all of them.
+double run_concurrent_streams(const std::shared_ptr<WhisperModel>& model, const std::shared_ptr<InferencePool>& pool,
+                              const std::vector<float>& audio, size_t channels) {
+    VoxSessionConfig config;
+    config.input_sample_rate = WP_WHISPER_SAMPLE_RATE;
+    config.inference_pool = pool;
+    config.event_callback = [](const VoxEvent&) {};
+
+    std::vector<std::unique_ptr<VoxSession>> sessions;
+    for (size_t i = 0; i < channels; ++i) {
+        std::unique_ptr<VoxSession> session = VoxSession::create(model, config);
+        if (!session) return -1.0;
+        sessions.push_back(std::move(session));
+    }
+
+    const size_t block = WP_WHISPER_SAMPLE_RATE / 10;
+    std::vector<size_t> fed(channels, 0);
+    auto start = std::chrono::steady_clock::now();
+    bool pending = true;
+    while (pending) {
+        pending = false;
+        bool progressed = false;
+        for (size_t i = 0; i < channels; ++i) {
+            if (fed[i] >= audio.size()) continue;
+            size_t n = std::min(block, audio.size() - fed[i]);
+            size_t accepted = sessions[i]->push_pcm(audio.data() + fed[i], n);
+            fed[i] += accepted;
+            progressed = progressed || accepted > 0;
+            pending = pending || fed[i] < audio.size();
+        }
+        if (pending && !progressed) std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    for (auto& session : sessions) session->finish();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int run_channels_benchmark(const BenchArgs& args) {
+    std::string model_path = args.get("model");
+    if (model_path.empty()) {
+        std::cerr << "Bench: --model is required." << std::endl;
+        return 1;
+    }
+    double seconds = args.get_number("seconds", 30.0);
+    int hardware_threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    size_t max_channels = static_cast<size_t>(args.get_number("max-channels", hardware_threads));
+    int fixed_workers = static_cast<int>(args.get_number("workers", 0));
+
+    std::shared_ptr<WhisperModel> model = WhisperModel::load(model_path, true);
+    if (!model) return 1;
+    bool synthetic = false;
+    std::vector<float> audio = load_calibration_audio(args.get("fixtures", "../fixtures"), seconds, &synthetic);
+    double audio_seconds = static_cast<double>(audio.size()) / WP_WHISPER_SAMPLE_RATE;
+
+    std::cout << "Model: " << model_path << ", " << audio_seconds << "s of " << (synthetic ? "synthetic " : "")
+              << "audio per stream, "
+              << hardware_threads << " hardware threads\n";
+    std::cout << std::setw(9) << "streams" << std::setw(9) << "workers" << std::setw(9) << "thr/job"
+              << std::setw(11) << "wall (s)" << std::setw(8) << "RTF" << "  real time?\n";
+
+    size_t sustained = 0;
+    for (size_t channels = 1; channels <= max_channels; ++channels) {
+        int workers = fixed_workers > 0 ? fixed_workers : std::min(static_cast<int>(channels), hardware_threads);
+        auto pool = std::make_shared<InferencePool>(workers, InferencePool::default_threads_per_job(workers));
+        double wall = run_concurrent_streams(model, pool, audio, channels);
+        if (wall < 0) return 1;
+        double rtf = wall / audio_seconds;
+        bool real_time = rtf <= 1.0;
+        std::cout << std::setw(9) << channels << std::setw(9) << workers << std::setw(9) << pool->threads_per_job()
+                  << std::setw(11) << std::fixed << std::setprecision(2) << wall
+                  << std::setw(8) << rtf << "  " << (real_time ? "yes" : "no") << "\n" << std::flush;
+        if (!real_time) break;
+        sustained = channels;
+    }
+    std::cout << "Sustained real-time streams: " << sustained << std::endl;
+    return 0;
+}
+
+// Discards preview output while keeping the renderer's full work.
+class NullStreamBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+struct SoakCounters {
+    uint64_t chunks = 0;
+    double chunk_seconds = 0.0;
+    uint64_t frames = 0;
+    double render_seconds = 0.0;
+};
+
+struct SoakSample {
+    double audio_hours = 0.0;
+    uint64_t chunks = 0;
+    size_t segments = 0;
+    size_t document_bytes = 0;
+    uint64_t rss_bytes = 0;
+    uint64_t live_allocations = 0;
+    double allocations_per_chunk = 0.0; // over the interval since the previous sample
+    double chunk_ms = 0.0;
+    double render_ms = 0.0;
+};
+
+// Takes interval averages against the previous call.
+class SoakSampler {
+public:
+    explicit SoakSampler(const DocumentFormatter& formatter) : m_formatter(formatter) {}
+
+    void sample(const SoakCounters& now) {
+        SoakSample s;
+        s.chunks = now.chunks;
+        s.audio_hours = static_cast<double>(now.chunks) * WP_PROCESSING_WINDOW_SECONDS_VAL / 3600.0;
+        std::vector<TextSegment> none;
+        uint64_t generation = 0;
+        s.segments = m_formatter.copy_segments_from(SIZE_MAX, none, generation);
+        s.document_bytes = m_formatter.get_markdown_document().size();
+        s.rss_bytes = process_resident_bytes();
+        uint64_t allocations = g_allocations.load(std::memory_order_relaxed);
+        s.live_allocations = allocations - g_frees.load(std::memory_order_relaxed);
+        uint64_t chunks = now.chunks - m_previous.chunks;
+        uint64_t frames = now.frames - m_previous.frames;
+        if (chunks > 0) {
+            s.allocations_per_chunk = static_cast<double>(allocations - m_previous_allocations) / static_cast<double>(chunks);
+            s.chunk_ms = 1000.0 * (now.chunk_seconds - m_previous.chunk_seconds) / static_cast<double>(chunks);
+        }
+        if (frames > 0) s.render_ms = 1000.0 * (now.render_seconds - m_previous.render_seconds) / static_cast<double>(frames);
+        m_previous = now;
+        m_previous_allocations = allocations;
+        samples.push_back(s);
+        print_row(s);
+    }
+
+    static void print_header() {
+        std::cout << std::setw(7) << "hours" << std::setw(8) << "chunks" << std::setw(10) << "segments"
+                  << std::setw(11) << "doc (KiB)" << std::setw(10) << "RSS (MiB)" << std::setw(13) << "live allocs"
+                  << std::setw(14) << "allocs/chunk" << std::setw(11) << "chunk (ms)" << std::setw(12) << "render (ms)" << "\n";
+    }
+
+    std::vector<SoakSample> samples;
+
+private:
+    static void print_row(const SoakSample& s) {
+        std::cout << std::fixed << std::setprecision(2) << std::setw(7) << s.audio_hours << std::setw(8) << s.chunks
+                  << std::setw(10) << s.segments << std::setw(11) << s.document_bytes / 1024
+                  << std::setw(10) << static_cast<double>(s.rss_bytes) / (1024.0 * 1024.0) << std::setw(13) << s.live_allocations
+                  << std::setw(14) << s.allocations_per_chunk << std::setw(11) << std::setprecision(3) << s.chunk_ms
+                  << std::setw(12) << s.render_ms << "\n" << std::flush;
+    }
+
+    const DocumentFormatter& m_formatter;
+    SoakCounters m_previous;
+    uint64_t m_previous_allocations = 0;
+};
+
+// Least-squares slope of log(y) over log(x): 0 = constant, 1 = linear, 2 = quadratic.
+double growth_exponent(const std::vector<std::pair<double, double>>& points) {
+    double n = 0, sx = 0, sy = 0, sxx = 0, sxy = 0;
+    for (const auto& [x, y] : points) {
+        if (x <= 0.0 || y <= 0.0) continue;
+        double lx = std::log(x), ly = std::log(y);
+        n += 1; sx += lx; sy += ly; sxx += lx * lx; sxy += lx * ly;
+    }
+    double denominator = n * sxx - sx * sx;
+    return (n < 3 || denominator <= 0.0) ? 0.0 : (n * sxy - sx * sy) / denominator;
+}
+
+// Flags per-chunk costs that grow with the session and memory that grows faster than linearly.
+// The first sample is warm-up and serves as the memory baseline.
+bool report_soak_growth(const std::vector<SoakSample>& samples) {
+    if (samples.size() < 4) {
+        std::cout << "Too few samples to judge growth." << std::endl;
+        return true;
+    }
+    const SoakSample& base = samples.front();
+    struct Check { const char* name; double exponent; double ratio; double limit; const char* meaning; };
+    // Per-chunk costs: fitted over the post-warm-up samples. Timing noise fits small exponents,
+    // so these are only flagged when the cost has also grown materially (ratio last/first).
+    auto per_chunk = [&](const char* name, const char* meaning, auto metric) {
+        std::vector<std::pair<double, double>> points;
+        for (size_t i = 1; i < samples.size(); ++i) points.emplace_back(static_cast<double>(samples[i].chunks), metric(samples[i]));
+        double first = metric(samples[1]);
+        double ratio = first > 0.0 ? metric(samples.back()) / first : 0.0;
+        return Check{name, growth_exponent(points), ratio, SOAK_GROWTH_EXPONENT_LIMIT, meaning};
+    };
+    // Memory: growth over the first sample, which may be up to linear in the session length.
+    auto since_base = [&](const char* name, const char* meaning, auto metric) {
+        std::vector<std::pair<double, double>> points;
+        for (size_t i = 1; i < samples.size(); ++i) {
+            points.emplace_back(static_cast<double>(samples[i].chunks - base.chunks), metric(samples[i]) - metric(base));
+        }
+        return Check{name, growth_exponent(points), -1.0, SOAK_MEMORY_EXPONENT_LIMIT, meaning};
+    };
+
+    const Check checks[] = {
+        per_chunk("chunk latency", "per-chunk work grows with the document", [](const SoakSample& s) { return s.chunk_ms; }),
+        per_chunk("render time", "preview frames grow with the document", [](const SoakSample& s) { return s.render_ms; }),
+        per_chunk("allocations/chunk", "allocation churn grows with the document", [](const SoakSample& s) { return s.allocations_per_chunk; }),
+        since_base("RSS growth", "memory grows super-linearly", [](const SoakSample& s) { return static_cast<double>(s.rss_bytes); }),
+        since_base("live allocations", "retained objects grow super-linearly", [](const SoakSample& s) { return static_cast<double>(s.live_allocations); }),
+    };
+    bool ok = true;
+    std::cout << "\nGrowth exponents over the session (0 = flat, 1 = linear):\n";
+    for (const Check& check : checks) {
+        bool flagged = check.exponent > check.limit && (check.ratio < 0.0 || check.ratio >= SOAK_MIN_FLAGGED_RATIO);
+        ok = ok && !flagged;
+        std::cout << "  " << std::left << std::setw(18) << check.name << std::right << std::setw(7) << std::setprecision(2)
+                  << check.exponent << "  (limit " << check.limit << ")";
+        if (check.ratio >= 0.0) std::cout << "  x" << check.ratio << " since warm-up";
+        if (flagged) std::cout << "  FLAGGED: " << check.meaning;
+        std::cout << "\n";
+    }
+    const SoakSample& last = samples.back();
+    if (last.chunks > base.chunks) {
+        std::cout << "Memory per chunk after warm-up: "
+                  << (static_cast<double>(last.rss_bytes) - static_cast<double>(base.rss_bytes)) / static_cast<double>(last.chunks - base.chunks)
+                  << " bytes RSS, " << static_cast<double>(last.document_bytes) / static_cast<double>(last.chunks) << " bytes of Markdown\n";
+    }
+    std::cout << (ok ? "No super-linear growth detected." : "Super-linear growth detected.") << std::endl;
+    return ok;
+}
+
+std::string synthetic_transcript(std::mt19937& rng, uint64_t chunk) {
+    static const char* const words[] = {"the", "meeting", "notes", "should", "cover", "budget", "review", "and", "next",
+                                        "steps", "for", "the", "launch", "we", "agreed", "to", "ship", "on", "friday",
+                                        "customer", "feedback", "was", "mostly", "positive", "about", "performance"};
+    std::uniform_int_distribution<size_t> pick(0, sizeof(words) / sizeof(words[0]) - 1);
+    std::uniform_int_distribution<int> length(8, 14);
+    std::string text;
+    // Commands every few chunks so formatted segments accumulate too.
+    if (chunk % 20 == 5) text += "format start bold ";
+    if (chunk % 20 == 9) text += "format stop bold ";
+    if (chunk % 30 == 12) text += "format start italics ";
+    if (chunk % 30 == 17) text += "format stop italics ";
+    for (int i = length(rng); i > 0; --i) {
+        text += words[pick(rng)];
+        text += ' ';
+    }
+    text.back() = '.';
+    return text;
+}
+
+// Formatter and preview only, with synthetic transcripts in place of decoding.
+bool run_text_soak(uint64_t total_chunks, uint64_t sample_every, int columns, std::vector<SoakSample>& samples) {
+    DocumentFormatter formatter;
+    NullStreamBuffer null_buffer;
+    std::ostream null_out(&null_buffer);
+    PreviewRenderer renderer(formatter, null_out);
+    renderer.set_use_ansi(true);
+    renderer.set_columns(columns);
+    SoakSampler sampler(formatter);
+    SoakSampler::print_header();
+
+    std::mt19937 rng(42);
+    SoakCounters counters;
+    for (uint64_t chunk = 1; chunk <= total_chunks; ++chunk) {
+        std::string text = synthetic_transcript(rng, chunk);
+        auto start = std::chrono::steady_clock::now();
+        formatter.process_transcribed_text(text);
+        auto committed = std::chrono::steady_clock::now();
+        renderer.render_frame();
+        auto rendered = std::chrono::steady_clock::now();
+        counters.chunks = chunk;
+        counters.chunk_seconds += std::chrono::duration<double>(committed - start).count();
+        counters.frames += 1;
+        counters.render_seconds += std::chrono::duration<double>(rendered - committed).count();
+        if (chunk % sample_every == 0 || chunk == total_chunks) sampler.sample(counters);
+    }
+    samples = sampler.samples;
+    return true;
+}
+
+// Full pipeline: looped audio pushed into a session as fast as it accepts it. Windows repeat
+// every loop, so after the first loop the transcript cache stands in for whisper.
+bool run_pipeline_soak(const BenchArgs& args, uint64_t total_chunks, uint64_t sample_every, int columns,
+                       std::vector<SoakSample>& samples) {
+    std::shared_ptr<WhisperModel> model = WhisperModel::load(args.get("model"), true);
+    if (!model) return false;
+    std::string cache_dir = args.get("cache-dir", (fs::temp_directory_path() / "voxformat-soak-cache").string());
+    std::shared_ptr<TranscriptCache> cache = TranscriptCache::open(cache_dir, 0);
+    if (!cache) return false;
+
+    // Whole windows only, so every loop produces the same windows (and cache keys).
+    const size_t window = static_cast<size_t>(WP_WHISPER_SAMPLE_RATE * WP_PROCESSING_WINDOW_SECONDS_VAL);
+    bool synthetic = false;
+    std::vector<float> audio = load_calibration_audio(args.get("fixtures", "../fixtures"), 120.0, &synthetic);
+    if (audio.size() < window) audio.resize(window, 0.0f);
+    audio.resize(audio.size() / window * window);
+
+    VoxSessionConfig config;
+    config.input_sample_rate = WP_WHISPER_SAMPLE_RATE;
+    config.event_callback = [](const VoxEvent&) {};
+    config.transcript_cache = cache;
+    std::unique_ptr<VoxSession> session = VoxSession::create(model, config);
+    if (!session) return false;
+
+    NullStreamBuffer null_buffer;
+    std::ostream null_out(&null_buffer);
+    PreviewRenderer renderer(session->formatter(), null_out);
+    renderer.set_use_ansi(true);
+    renderer.set_columns(columns);
+    SoakSampler sampler(session->formatter());
+    std::cout << "Audio loop: " << static_cast<double>(audio.size()) / WP_WHISPER_SAMPLE_RATE << "s"
+              << (synthetic ? " (synthetic)" : "") << ", cache: " << cache_dir << "\n";
+    SoakSampler::print_header();
+
+    const uint64_t total_samples = total_chunks * window;
+    const size_t block = WP_WHISPER_SAMPLE_RATE / 10;
+    uint64_t pushed = 0;
+    uint64_t next_sample_chunk = sample_every;
+    uint64_t seen_revision = session->formatter().get_revision();
+    SoakCounters counters;
+    auto take_counters = [&]() {
+        ProcessorMetrics metrics = session->processor().get_metrics();
+        counters.chunks = metrics.chunks_processed;
+        counters.chunk_seconds = metrics.total_chunk_seconds;
+    };
+    auto render_if_changed = [&]() {
+        uint64_t revision = session->formatter().get_revision();
+        if (revision == seen_revision) return;
+        seen_revision = revision;
+        auto start = std::chrono::steady_clock::now();
+        renderer.render_frame();
+        counters.render_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        counters.frames += 1;
+    };
+
+    while (pushed < total_samples) {
+        // Stay a couple of windows ahead of the worker so samples line up with the audio pushed.
+        size_t accepted = 0;
+        if (pushed / window < counters.chunks + 2) {
+            size_t offset = static_cast<size_t>(pushed % audio.size());
+            size_t n = static_cast<size_t>(std::min<uint64_t>({block, audio.size() - offset, total_samples - pushed}));
+            accepted = session->push_pcm(audio.data() + offset, n);
+            pushed += accepted;
+        }
+        if (accepted == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        render_if_changed();
+        take_counters();
+        if (counters.chunks >= next_sample_chunk) {
+            sampler.sample(counters);
+            next_sample_chunk += sample_every;
+        }
+    }
+    session->finish();
+    render_if_changed();
+    take_counters();
+    sampler.sample(counters);
+    TranscriptCacheStats stats = cache->stats();
+    std::cout << "Transcript cache: " << stats.hits << " hit(s), " << stats.misses << " miss(es)\n";
+    samples = sampler.samples;
+    return true;
+}
+
+int run_soak_benchmark(const BenchArgs& args) {
+    double hours = args.get_number("hours", SOAK_DEFAULT_HOURS);
+    uint64_t sample_count = static_cast<uint64_t>(std::max(4.0, args.get_number("samples", SOAK_DEFAULT_SAMPLES)));
+    int columns = static_cast<int>(args.get_number("columns", 100));
+    uint64_t total_chunks = static_cast<uint64_t>(hours * 3600.0 / WP_PROCESSING_WINDOW_SECONDS_VAL);
+    if (total_chunks < sample_count) {
+        std::cerr << "Bench: --hours is too short for " << sample_count << " samples." << std::endl;
+        return 1;
+    }
+    uint64_t sample_every = total_chunks / sample_count;
+    bool with_model = !args.get("model").empty();
+    std::cout << "Soak: " << hours << "h of dictation (" << total_chunks << " chunks of " << WP_PROCESSING_WINDOW_SECONDS_VAL
+              << "s), " << (with_model ? "full pipeline with " + args.get("model") : std::string("synthetic transcripts, no model")) << "\n";
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<SoakSample> samples;
+    bool ran = with_model ? run_pipeline_soak(args, total_chunks, sample_every, columns, samples)
+                          : run_text_soak(total_chunks, sample_every, columns, samples);
+    if (!ran) return 1;
+    std::cout << "Wall time: " << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << "s" << std::endl;
+    return report_soak_growth(samples) ? 0 : 2;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2 || std::string(argv[1]) == "--help" || std::string(argv[1]) == "-h") {
+        print_bench_usage(argv[0]);
+        return argc < 2 ? 1 : 0;
+    }
+    std::string command = argv[1];
+    BenchArgs args;
+    if (!parse_bench_args(argc, argv, 2, args)) return 1;
+    try {
+        if (command == "channels") return run_channels_benchmark(args);
+        if (command == "soak") return run_soak_benchmark(args);
+    } catch (const std::exception& e) {
+        std::cerr << "Bench: " << e.what() << std::endl;
+        return 1;
+    }
+    std::cerr << "Bench: Unknown benchmark '" << command << "'" << std::endl;
+    print_bench_usage(argv[0]);
+    return 1;
+}
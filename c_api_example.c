@@ -0,0 +1,63 @@
+/* c_api_example.c - drives the libvoxformat C API from plain C.
+ *   voxformat_c_example MODEL_PATH
+ * Feeds a few seconds of synthetic audio through one session, prints the queued events and
+ * the resulting Markdown, and exits non-zero if any API call fails.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "voxformat.h"
+
+#define EXAMPLE_SECONDS 6
+#define EXAMPLE_BLOCK 1600 /* 100 ms at 16 kHz */
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s MODEL_PATH\n", argv[0]);
+        return 1;
+    }
+    vox_model* model = vox_model_load(argv[1], 0);
+    if (!model) {
+        fprintf(stderr, "vox_model_load failed\n");
+        return 1;
+    }
+    vox_session_config config = vox_session_default_config(); /* no callback: events are queued */
+    vox_session* session = vox_session_create(model, &config);
+    vox_model_free(model); /* the session keeps its own reference */
+    if (!session) {
+        fprintf(stderr, "vox_session_create failed\n");
+        return 1;
+    }
+
+    int status = 0;
+    float block[EXAMPLE_BLOCK];
+    size_t total = (size_t)config.input_sample_rate * EXAMPLE_SECONDS;
+    for (size_t pushed = 0; pushed < total && status == 0; pushed += EXAMPLE_BLOCK) {
+        for (size_t i = 0; i < EXAMPLE_BLOCK; ++i) {
+            double t = (double)(pushed + i) / config.input_sample_rate;
+            block[i] = (float)(0.3 * sin(2.0 * 3.14159265358979 * (220.0 + 40.0 * floor(t)) * t));
+        }
+        if (vox_session_push_pcm(session, block, EXAMPLE_BLOCK) != 0) status = 1;
+    }
+    if (vox_session_finish(session) != 0) status = 1;
+
+    vox_event event;
+    int polled;
+    while ((polled = vox_session_poll_event(session, &event)) == 1) {
+        if (event.type == VOX_EVENT_FORMAT) printf("format event %d\n", (int)event.format);
+        else printf("%s transcript: %s\n", event.type == VOX_EVENT_FINAL_TRANSCRIPT ? "final" : "partial", event.text);
+    }
+    if (polled < 0) status = 1;
+
+    size_t needed = vox_session_get_markdown(session, NULL, 0);
+    char* markdown = needed > 0 ? (char*)malloc(needed) : NULL;
+    if (!markdown || vox_session_get_markdown(session, markdown, needed) != needed) {
+        status = 1;
+    } else {
+        printf("--- Markdown ---\n%s\n", markdown);
+    }
+    free(markdown);
+    vox_session_free(session);
+    if (status != 0) fprintf(stderr, "A libvoxformat call failed\n");
+    return status;
+}
@@ -0,0 +1,374 @@
+#include "document_exporter.h"
+#include "markdown_builder.h"
+#include "word_index.h"
+#include "pipeline_trace.h"
+#include <iostream>
+#include <filesystem>
+#include <cstring>
+#include <cerrno>
+#include <sstream>
+#include <atomic>
+#include <thread>
+#include <chrono>
+
+#if !defined(_WIN32)
+#include <sys/uio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::atomic<uint64_t> g_temp_counter{0};
+
+// Unique per process, thread and call, so concurrent saves of the same document (another
+// session, or a replay next to a live run) never write to each other's temporary file.
+std::string unique_temp_path(const std::string& path) {
+    std::ostringstream name;
+    name << path << ".tmp.";
+#if !defined(_WIN32)
+    name << ::getpid() << ".";
+#endif
+    name << std::hash<std::thread::id>{}(std::this_thread::get_id()) << "."
+         << std::chrono::steady_clock::now().time_since_epoch().count() << "."
+         << g_temp_counter.fetch_add(1, std::memory_order_relaxed);
+    return name.str();
+}
+
+// Temporary files of this target left behind by a save that never committed.
+void remove_stale_temps(const std::string& path) {
+    fs::path target(path);
+    fs::path dir = target.parent_path().empty() ? fs::path(".") : target.parent_path();
+    const std::string prefix = target.filename().string() + ".tmp.";
+    std::error_code ec;
+    for (const fs::directory_entry& entry : fs::directory_iterator(dir, ec)) {
+        if (entry.path().filename().string().rfind(prefix, 0) != 0) continue;
+        std::error_code entry_ec;
+        auto age = fs::file_time_type::clock::now() - entry.last_write_time(entry_ec);
+        if (!entry_ec && age >= std::chrono::seconds(DE_STALE_TEMP_SECONDS)) fs::remove(entry.path(), entry_ec);
+    }
+}
+
+// Markdown as the formatter has always saved it, plus the word index beside it. The index is
+// written only after the Markdown is in place, so it never describes a document that was not saved.
+class MarkdownExportWriter : public ExportWriter {
+public:
+    void write_segment(const TextSegment& segment, ExportFile& out) override {
+        m_scratch.clear();
+        if (!m_builder.append_segment(segment, m_scratch, nullptr, &m_word_offsets)) return;
+        for (size_t i = 0; i < segment.words.size(); ++i) {
+            if (m_word_offsets[i] == SIZE_MAX) continue;
+            const WordTiming& word = segment.words[i];
+            m_word_index.push_back({static_cast<uint32_t>(out.bytes_written() + m_word_offsets[i]), word.length,
+                                    word.start_ms, word.end_ms});
+        }
+        out.write(m_scratch);
+    }
+
+    bool committed(const ExportFile& out) override {
+        const std::string index_path = out.path() + WI_FILE_SUFFIX;
+        if (m_word_index.empty()) {
+            // An index left by an earlier save would point into text that is gone.
+            std::error_code ec;
+            fs::remove(index_path, ec);
+            return true;
+        }
+        return write_word_index(index_path, m_word_index, out.bytes_written());
+    }
+
+private:
+    MarkdownBuilder m_builder;
+    std::string m_scratch;
+    std::vector<size_t> m_word_offsets;
+    std::vector<WordIndexEntry> m_word_index;
+};
+
+// The Markdown spacing rules without emphasis markers; shared by the non-Markdown formats.
+class PlainTextBuilder {
+public:
+    // Returns the segment's text, preceded by a space where the document needs one.
+    const std::string& append(const TextSegment& segment) {
+        m_scratch.clear();
+        m_plain.text = segment.text;
+        m_builder.append_segment(m_plain, m_scratch);
+        return m_scratch;
+    }
+
+private:
+    MarkdownBuilder m_builder;
+    TextSegment m_plain;
+    std::string m_scratch;
+};
+
+class TextExportWriter : public ExportWriter {
+public:
+    void write_segment(const TextSegment& segment, ExportFile& out) override {
+        out.write(m_plain.append(segment));
+    }
+    bool end(ExportFile& out) override {
+        out.write("\n");
+        return true;
+    }
+
+private:
+    PlainTextBuilder m_plain;
+};
+
+class HtmlExportWriter : public ExportWriter {
+public:
+    void begin(ExportFile& out) override {
+        out.write("<!DOCTYPE html>\n<html>\n<head>\n<meta charset=\"utf-8\">\n<title>VoxFormat document</title>\n</head>\n<body>\n<p>");
+    }
+
+    void write_segment(const TextSegment& segment, ExportFile& out) override {
+        const std::string& text = m_plain.append(segment);
+        if (text.empty()) return;
+        size_t start = 0;
+        if (text.front() == ' ') {
+            out.write(" ");
+            start = 1;
+        }
+        if (segment.is_bold) out.write("<strong>");
+        if (segment.is_italic) out.write("<em>");
+        m_escaped.clear();
+        for (size_t i = start; i < text.size(); ++i) {
+            switch (text[i]) {
+                case '&': m_escaped += "&amp;"; break;
+                case '<': m_escaped += "&lt;"; break;
+                case '>': m_escaped += "&gt;"; break;
+                case '"': m_escaped += "&quot;"; break;
+                default: m_escaped.push_back(text[i]);
+            }
+        }
+        out.write(m_escaped);
+        if (segment.is_italic) out.write("</em>");
+        if (segment.is_bold) out.write("</strong>");
+    }
+
+    bool end(ExportFile& out) override {
+        out.write("</p>\n</body>\n</html>\n");
+        return true;
+    }
+
+private:
+    PlainTextBuilder m_plain;
+    std::string m_escaped;
+};
+
+template <typename Writer>
+std::unique_ptr<ExportWriter> create_writer() {
+    return std::make_unique<Writer>();
+}
+
+} // namespace
+
+const std::vector<ExportFormat>& export_formats() {
+    static const std::vector<ExportFormat> formats = {
+        {"md", "md", &create_writer<MarkdownExportWriter>},
+        {"html", "html", &create_writer<HtmlExportWriter>},
+        {"txt", "txt", &create_writer<TextExportWriter>},
+    };
+    return formats;
+}
+
+const ExportFormat* find_export_format(const std::string& name) {
+    for (const ExportFormat& format : export_formats()) {
+        if (name == format.name) return &format;
+    }
+    return nullptr;
+}
+
+ExportFile::~ExportFile() {
+    if (!m_temp_path.empty()) {
+        close_file();
+        std::error_code ec;
+        fs::remove(m_temp_path, ec);
+    }
+}
+
+bool ExportFile::open(const std::string& path) {
+    m_path = path;
+    remove_stale_temps(path);
+    m_temp_path = unique_temp_path(path);
+    m_buffer.reserve(DE_BUFFER_BYTES);
+#if defined(_WIN32)
+    m_file = std::fopen(m_temp_path.c_str(), "wbx");
+    bool opened = m_file != nullptr;
+#else
+    m_fd = ::open(m_temp_path.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0644);
+    bool opened = m_fd >= 0;
+#endif
+    if (!opened) {
+        std::cerr << "--- Error: Could not open file " << m_temp_path << " for saving: " << std::strerror(errno) << " ---" << std::endl;
+        m_temp_path.clear();
+        m_failed = true;
+    }
+    return opened;
+}
+
+void ExportFile::write(std::string_view data) {
+    if (m_failed) return;
+    m_bytes_written += data.size();
+    if (m_buffer.size() + data.size() <= DE_BUFFER_BYTES) {
+        m_buffer.append(data);
+    } else if (data.size() < DE_BUFFER_BYTES) {
+        flush();
+        m_buffer.append(data);
+    } else {
+        flush(data);
+    }
+}
+
+void ExportFile::flush(std::string_view extra) {
+    if (m_failed || (m_buffer.empty() && extra.empty())) return;
+#if defined(_WIN32)
+    if (std::fwrite(m_buffer.data(), 1, m_buffer.size(), m_file) != m_buffer.size() ||
+        std::fwrite(extra.data(), 1, extra.size(), m_file) != extra.size()) {
+        m_failed = true;
+    }
+#else
+    iovec parts[2] = {{m_buffer.data(), m_buffer.size()}, {const_cast<char*>(extra.data()), extra.size()}};
+    iovec* next = parts;
+    int count = extra.empty() ? 1 : 2;
+    while (count > 0) {
+        ssize_t written = ::writev(m_fd, next, count);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            m_failed = true;
+            break;
+        }
+        // Skip whatever a partial write took and retry with the rest.
+        size_t remaining = static_cast<size_t>(written);
+        while (count > 0 && remaining >= next->iov_len) {
+            remaining -= next->iov_len;
+            ++next;
+            --count;
+        }
+        if (count > 0) {
+            next->iov_base = static_cast<char*>(next->iov_base) + remaining;
+            next->iov_len -= remaining;
+        }
+    }
+#endif
+    if (m_failed) std::cerr << "--- Error: Could not write " << m_temp_path << ": " << std::strerror(errno) << " ---" << std::endl;
+    m_buffer.clear();
+}
+
+void ExportFile::close_file() {
+#if defined(_WIN32)
+    if (m_file && std::fclose(m_file) != 0) m_failed = true;
+    m_file = nullptr;
+#else
+    if (m_fd >= 0 && ::close(m_fd) != 0) m_failed = true;
+    m_fd = -1;
+#endif
+}
+
+bool ExportFile::commit() {
+    if (m_temp_path.empty()) return false;
+    flush();
+#if !defined(_WIN32)
+    // The rename must not become visible before the data it points to.
+    if (!m_failed && ::fsync(m_fd) != 0) m_failed = true;
+#endif
+    close_file();
+    if (m_failed) return false;
+    std::error_code ec;
+    fs::rename(m_temp_path, m_path, ec);
+    if (ec) {
+        std::cerr << "--- Error: Could not replace " << m_path << ": " << ec.message() << " ---" << std::endl;
+        return false;
+    }
+    m_temp_path.clear();
+    return true;
+}
+
+bool export_document(const DocumentFormatter& formatter, std::vector<ExportTarget>& targets) {
+    VOX_TRACE_SCOPE("save_document", "output");
+#if defined(VOXFORMAT_ENABLE_TRACING)
+    uint64_t trace_chunk = 0, trace_commit_us = 0;
+    if (PipelineTrace::enabled()) formatter.get_last_commit_trace(trace_chunk, trace_commit_us);
+#endif
+
+    // Null for targets that were skipped because their directory could not be created.
+    std::vector<std::unique_ptr<ExportFile>> files;
+    for (ExportTarget& target : targets) {
+        fs::path output_dir_p = fs::path(target.path).parent_path();
+        bool dir_ok = true;
+        try {
+            if (!output_dir_p.empty() && !fs::exists(output_dir_p) && !fs::create_directories(output_dir_p)) {
+                std::cerr << "--- Error: Could not create directory " << output_dir_p.string() << " ---" << std::endl;
+                dir_ok = false;
+            }
+        } catch (const fs::filesystem_error& e) {
+            std::cerr << "--- Filesystem Error during save: " << e.what() << " ---" << std::endl;
+            dir_ok = false;
+        }
+        if (!dir_ok) {
+            files.push_back(nullptr);
+            continue;
+        }
+        files.push_back(std::make_unique<ExportFile>());
+        if (files.back()->open(target.path)) target.writer->begin(*files.back());
+    }
+
+    // Copy a batch of segments at a time, so the worker is never blocked for the whole export.
+    std::vector<TextSegment> batch;
+    size_t next_index = 0;
+    uint64_t generation = 0;
+    bool cleared = false;
+    while (true) {
+        uint64_t batch_generation = 0;
+        size_t total = formatter.copy_segments(next_index, DE_SEGMENT_BATCH, batch, batch_generation);
+        if (next_index == 0) generation = batch_generation;
+        if (batch_generation != generation) {
+            cleared = true;
+            break;
+        }
+        for (const TextSegment& segment : batch) {
+            for (size_t i = 0; i < targets.size(); ++i) {
+                if (files[i] && !files[i]->failed()) targets[i].writer->write_segment(segment, *files[i]);
+            }
+        }
+        next_index += batch.size();
+        if (batch.empty() || next_index >= total) break;
+    }
+    if (cleared) {
+        std::cerr << "--- Error: The document was cleared while saving; nothing was written. ---" << std::endl;
+        return false;
+    }
+
+    bool all_saved = true;
+    for (size_t i = 0; i < targets.size(); ++i) {
+        if (!files[i]) {
+            all_saved = false;
+            continue;
+        }
+        ExportFile& file = *files[i];
+        bool saved = !file.failed() && targets[i].writer->end(file) && file.commit();
+        if (saved) std::cout << "--- Document saved to " << fs::absolute(file.path()).string() << " ---" << std::endl;
+        all_saved = all_saved && saved && targets[i].writer->committed(file);
+    }
+#if defined(VOXFORMAT_ENABLE_TRACING)
+    if (trace_chunk != 0 && all_saved) {
+        PipelineTrace::async_begin("commit_to_disk", trace_chunk, trace_commit_us);
+        PipelineTrace::async_end("commit_to_disk", trace_chunk, PipelineTrace::now_us());
+    }
+#endif
+    return all_saved;
+}
+
+bool export_document(const DocumentFormatter& formatter, const std::string& base_path, const std::vector<std::string>& formats) {
+    std::vector<ExportTarget> targets;
+    for (const std::string& name : formats) {
+        const ExportFormat* format = find_export_format(name);
+        if (!format) {
+            std::cerr << "--- Error: Unknown export format '" << name << "' ---" << std::endl;
+            return false;
+        }
+        targets.push_back({base_path + "." + format->extension, format->create()});
+    }
+    return export_document(formatter, targets);
+}
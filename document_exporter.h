@@ -0,0 +1,86 @@
+#ifndef DOCUMENT_EXPORTER_H
+#define DOCUMENT_EXPORTER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <cstdio>
+#include <cstdint>
+#include "document_formatter.h"
+
+#define DE_BUFFER_BYTES (64 * 1024) // per output file
+#define DE_SEGMENT_BATCH 256        // segments copied out of the formatter per lock
+#define DE_STALE_TEMP_SECONDS 600   // temporary files this old were left by a save that died
+
+// Output file written through a fixed buffer under a unique temporary name. commit() renames it
+// over the target, so readers see the old file or the complete new one, never a partial one.
+class ExportFile {
+public:
+    ExportFile() = default;
+    ~ExportFile(); // discards the temporary file unless committed
+    ExportFile(const ExportFile&) = delete;
+    ExportFile& operator=(const ExportFile&) = delete;
+
+    bool open(const std::string& path); // reports problems on std::cerr
+    // Data that does not fit the buffer is written together with it in one vectored write.
+    void write(std::string_view data);
+    bool commit();
+
+    const std::string& path() const { return m_path; }
+    uint64_t bytes_written() const { return m_bytes_written; } // including what is still buffered
+    bool failed() const { return m_failed; }
+
+private:
+    void flush(std::string_view extra = {});
+    void close_file();
+
+    std::string m_path;
+    std::string m_temp_path;
+    std::string m_buffer;
+    uint64_t m_bytes_written = 0;
+    bool m_failed = false;
+#if defined(_WIN32)
+    std::FILE* m_file = nullptr;
+#else
+    int m_fd = -1;
+#endif
+};
+
+// One output format. The exporter walks the document once and hands every segment to every
+// writer in order; writers keep only what their format needs between segments.
+class ExportWriter {
+public:
+    virtual ~ExportWriter() = default;
+    virtual void begin(ExportFile& out) { (void)out; }
+    virtual void write_segment(const TextSegment& segment, ExportFile& out) = 0;
+    // Called after the last segment, before the file is committed. Returns false on failure.
+    virtual bool end(ExportFile& out) { (void)out; return true; }
+    // Called once the file has been committed, for files that belong next to it. Returns false on failure.
+    virtual bool committed(const ExportFile& out) { (void)out; return true; }
+};
+
+struct ExportFormat {
+    const char* name;      // as given to --export
+    const char* extension; // without the dot
+    std::unique_ptr<ExportWriter> (*create)();
+};
+
+// Known formats. Adding one takes an ExportWriter and an entry in this table.
+const std::vector<ExportFormat>& export_formats();
+const ExportFormat* find_export_format(const std::string& name);
+
+struct ExportTarget {
+    std::string path;
+    std::unique_ptr<ExportWriter> writer;
+};
+
+// Writes every target in a single pass over the segments. Memory use does not depend on the
+// document's length, apart from the Markdown writer's word index (16 bytes per timed word).
+// Returns false if any target failed; the others are still written. A target whose directory
+// cannot be created is skipped.
+bool export_document(const DocumentFormatter& formatter, std::vector<ExportTarget>& targets);
+// One target per format name, at base_path + "." + extension.
+bool export_document(const DocumentFormatter& formatter, const std::string& base_path, const std::vector<std::string>& formats);
+
+#endif // DOCUMENT_EXPORTER_H
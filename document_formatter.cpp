@@ -1,27 +1,111 @@
 // document_formatter.cpp
 #include "document_formatter.h"
+#include "markdown_builder.h"
+#include "document_exporter.h"
 #include "utils.h"
+#include "pipeline_trace.h"
 #include <iostream>
-#include <fstream>
-#include <filesystem>
 #include <algorithm>
-#include <regex>
+#include <cctype>
+#include <cstdint>
 
-namespace fs = std::filesystem;
+// How far past the last matched word to look for the next one. Covers a spoken command
+// ("format start italics") and a removed artifact between two words of text.
+#define DF_WORD_MATCH_LOOKAHEAD 8
+
+namespace {
+
+// Lowercase letters and digits only, so "Hello," in the document matches "hello" from the decoder.
+std::string word_match_key(const std::string& word) {
+    std::string key;
+    for (unsigned char c : word) {
+        if (std::isalnum(c) || c >= 0x80) key.push_back(static_cast<char>(std::tolower(c)));
+    }
+    return key.empty() ? word : key;
+}
+
+} // namespace
 
 DocumentFormatter::DocumentFormatter() : m_is_bold_active(false), m_is_italic_active(false) {
     m_should_stop_application.store(false);
 }
 
 void DocumentFormatter::clear_document(){
+    {
+        std::lock_guard<std::mutex> lock(m_doc_mutex);
+        m_document_segments.clear();
+        m_is_bold_active = false;
+        m_is_italic_active = false;
+        ++m_generation;
+        m_revision.fetch_add(1, std::memory_order_release);
+    }
+    notify_changed();
+}
+
+size_t DocumentFormatter::copy_segments_from(size_t first_index, std::vector<TextSegment>& out, uint64_t& generation_out) const {
+    return copy_segments(first_index, SIZE_MAX, out, generation_out);
+}
+
+size_t DocumentFormatter::copy_segments(size_t first_index, size_t max_count, std::vector<TextSegment>& out, uint64_t& generation_out) const {
+    std::lock_guard<std::mutex> lock(m_doc_mutex);
+    out.clear();
+    generation_out = m_generation;
+    if (first_index < m_document_segments.size()) {
+        size_t count = std::min(max_count, m_document_segments.size() - first_index);
+        auto first = m_document_segments.begin() + static_cast<std::ptrdiff_t>(first_index);
+        out.assign(first, first + static_cast<std::ptrdiff_t>(count));
+    }
+    return m_document_segments.size();
+}
+
+void DocumentFormatter::set_change_listener(std::function<void()> listener) {
     std::lock_guard<std::mutex> lock(m_doc_mutex);
-    m_document_segments.clear();
-    m_is_bold_active = false;
-    m_is_italic_active = false;
+    m_change_listener = std::move(listener);
 }
 
-void DocumentFormatter::process_transcribed_text(const std::string& text_from_whisper_raw) {
+void DocumentFormatter::set_event_listener(std::function<void(FormatEvent)> listener) {
     std::lock_guard<std::mutex> lock(m_doc_mutex);
+    m_event_listener = std::move(listener);
+}
+
+void DocumentFormatter::notify_changed(const std::vector<FormatEvent>& events) {
+    std::function<void()> listener;
+    std::function<void(FormatEvent)> event_listener;
+    {
+        std::lock_guard<std::mutex> lock(m_doc_mutex);
+        listener = m_change_listener;
+        if (!events.empty()) event_listener = m_event_listener;
+    }
+    if (listener) listener();
+    if (event_listener) {
+        for (FormatEvent event : events) event_listener(event);
+    }
+}
+
+void DocumentFormatter::push_text_segment(const std::string& text, const std::vector<SpokenWord>& words, size_t& next_word) {
+    TextSegment segment{text, m_is_bold_active, m_is_italic_active};
+    size_t pos = 0;
+    while (next_word < words.size() && pos < text.size()) {
+        size_t start = text.find_first_not_of(' ', pos);
+        if (start == std::string::npos) break;
+        size_t end = std::min(text.find(' ', start), text.size());
+        pos = end;
+        std::string key = word_match_key(text.substr(start, end - start));
+        size_t last = std::min(words.size(), next_word + DF_WORD_MATCH_LOOKAHEAD);
+        for (size_t w = next_word; w < last; ++w) {
+            if (word_match_key(words[w].text) != key) continue;
+            segment.words.push_back({static_cast<uint32_t>(start), static_cast<uint32_t>(end - start),
+                                     words[w].start_ms, words[w].end_ms});
+            next_word = w + 1;
+            break;
+        }
+    }
+    m_document_segments.push_back(std::move(segment));
+}
+
+void DocumentFormatter::process_transcribed_text(const std::string& text_from_whisper_raw, const std::vector<SpokenWord>& words) {
+    VOX_TRACE_SCOPE("process_transcribed_text", "text");
+    std::unique_lock<std::mutex> lock(m_doc_mutex);
 
     std::string original_segment_text = cleanup_stt_artifacts_util(text_from_whisper_raw);
     if (original_segment_text.empty()) {
@@ -53,6 +137,8 @@ void DocumentFormatter::process_transcribed_text(const std::string& text_from_wh
     const std::string CMD_SI_L = "start italics";   const std::string CMD_XI_L = "stop italics";
     const std::string CMD_XA_L = "stop application";
     // Save command removed
+    std::vector<FormatEvent> events;
+    size_t next_word = 0;
 
     size_t current_pos = 0;
     while(current_pos < text_left_to_parse.length()) {
@@ -67,7 +153,7 @@ void DocumentFormatter::process_transcribed_text(const std::string& text_from_wh
         if (actual_keyword_start == std::string::npos) {
             std::string text_part = trim_string_util(remaining_original_case);
             if (!text_part.empty()) {
-                m_document_segments.push_back({text_part, m_is_bold_active, m_is_italic_active});
+                push_text_segment(text_part, words, next_word);
             }
             break;
         }
@@ -75,7 +161,7 @@ void DocumentFormatter::process_transcribed_text(const std::string& text_from_wh
         if (actual_keyword_start > current_pos) {
             std::string text_part = trim_string_util(text_left_to_parse.substr(current_pos, actual_keyword_start - current_pos));
             if (!text_part.empty()) {
-                m_document_segments.push_back({text_part, m_is_bold_active, m_is_italic_active});
+                push_text_segment(text_part, words, next_word);
             }
         }
 
@@ -94,14 +180,19 @@ void DocumentFormatter::process_transcribed_text(const std::string& text_from_wh
         if (!action_candidate_lower.empty()) {
             if (action_candidate_lower.rfind(CMD_SB_L, 0) == 0 && (action_candidate_lower.length() == CMD_SB_L.length() || !isalnum(action_candidate_lower[CMD_SB_L.length()]))) {
                 m_is_bold_active = true; matched_action_constant_l = CMD_SB_L; cmd_recognized = true;
+                events.push_back(FormatEvent::BoldOn);
             } else if (action_candidate_lower.rfind(CMD_XB_L, 0) == 0 && (action_candidate_lower.length() == CMD_XB_L.length() || !isalnum(action_candidate_lower[CMD_XB_L.length()]))) {
                 m_is_bold_active = false; matched_action_constant_l = CMD_XB_L; cmd_recognized = true;
+                events.push_back(FormatEvent::BoldOff);
             } else if (action_candidate_lower.rfind(CMD_SI_L, 0) == 0 && (action_candidate_lower.length() == CMD_SI_L.length() || !isalnum(action_candidate_lower[CMD_SI_L.length()]))) {
                 m_is_italic_active = true; matched_action_constant_l = CMD_SI_L; cmd_recognized = true;
+                events.push_back(FormatEvent::ItalicOn);
             } else if (action_candidate_lower.rfind(CMD_XI_L, 0) == 0 && (action_candidate_lower.length() == CMD_XI_L.length() || !isalnum(action_candidate_lower[CMD_XI_L.length()]))) {
                 m_is_italic_active = false; matched_action_constant_l = CMD_XI_L; cmd_recognized = true;
+                events.push_back(FormatEvent::ItalicOff);
             } else if (action_candidate_lower.rfind(CMD_XA_L, 0) == 0 && (action_candidate_lower.length() == CMD_XA_L.length() || !isalnum(action_candidate_lower[CMD_XA_L.length()]))) {
                 signal_stop_application(); matched_action_constant_l = CMD_XA_L; cmd_recognized = true;
+                events.push_back(FormatEvent::StopApplication);
             }
         }
 
@@ -110,7 +201,7 @@ void DocumentFormatter::process_transcribed_text(const std::string& text_from_wh
         } else {
             std::string literal_keyword_part = trim_string_util(text_left_to_parse.substr(actual_keyword_start, KW_PREFIX_L.length()));
              if (!literal_keyword_part.empty()) {
-                 m_document_segments.push_back({literal_keyword_part, m_is_bold_active, m_is_italic_active});
+                 push_text_segment(literal_keyword_part, words, next_word);
             }
         }
         current_pos = actual_keyword_start + total_consumed_for_command_phrase;
@@ -118,178 +209,37 @@ void DocumentFormatter::process_transcribed_text(const std::string& text_from_wh
             current_pos++;
         }
     }
+#if defined(VOXFORMAT_ENABLE_TRACING)
+    if (PipelineTrace::enabled()) {
+        m_trace_last_chunk = PipelineTrace::current_chunk();
+        m_trace_last_commit_us = PipelineTrace::now_us();
+    }
+#endif
+    m_revision.fetch_add(1, std::memory_order_release);
+    lock.unlock();
+    notify_changed(events);
 }
 
-void DocumentFormatter::print_current_document_preview() const {
+void DocumentFormatter::get_last_commit_trace(uint64_t& chunk_id, uint64_t& committed_us) const {
     std::lock_guard<std::mutex> lock(m_doc_mutex);
-    std::cout << "\n\n--- DOCUMENT PREVIEW ---\n";
-    std::string md_output_str = "";
-    for (size_t i = 0; i < m_document_segments.size(); ++i) {
-        const auto& seg = m_document_segments[i];
-        std::string current_segment_text = seg.text; // This should be pre-trimmed
-        while (!current_segment_text.empty() &&
-           std::isspace((unsigned char)current_segment_text.back())) {
-            current_segment_text.pop_back();
-           }
-
-        // Skip adding this segment if it's empty and carries no formatting change
-        // This check helps avoid "** **" if an empty segment was created with bold on.
-        if (current_segment_text.empty() &&
-            !(i > 0 && (seg.is_bold != m_document_segments[i-1].is_bold || seg.is_italic != m_document_segments[i-1].is_italic)) &&
-            !(i == 0 && (seg.is_bold || seg.is_italic))) { // Don't skip if it's an initial empty formatting segment
-            continue;
-        }
-
-        // Add a space separator if:
-        // 1. md_output_str is not empty (i.e., this isn't the first piece of content).
-        // 2. md_output_str doesn't already end with a space.
-        // 3. current_segment_text doesn't start with a space (it shouldn't if trimmed).
-        // 4. And no intervening punctuation that makes a space look weird.
-        if (!md_output_str.empty() && !current_segment_text.empty()) {
-            if (md_output_str.back() != ' ' && current_segment_text.front() != ' ') {
-                char last_char_of_md = ' ';
-                // Iterate backwards through md_output_str to find the last *actual* text character
-                for (long k_md = md_output_str.length() - 1; k_md >= 0; --k_md) {
-                    if (md_output_str[k_md] != '*' && md_output_str[k_md] != '_') { // Assuming _ for underline later
-                        last_char_of_md = md_output_str[k_md];
-                        break;
-                    }
-                    if (k_md == 0) last_char_of_md = md_output_str[k_md]; // If all were markdown chars
-                }
-
-                char first_char_of_new = current_segment_text.front();
-                bool prev_ends_opening_markup = (std::string("([{\"*").find(last_char_of_md) != std::string::npos);
-                bool current_starts_closing_markup = (std::string(",.!?;:'\")*").find(first_char_of_new) != std::string::npos);
-
-                if (!prev_ends_opening_markup && !current_starts_closing_markup) {
-                    md_output_str += " ";
-                }
-            }
-        }
-
-        std::string text_to_append = current_segment_text;
-        if (seg.is_bold && seg.is_italic) {
-            text_to_append = "***" + text_to_append + "***";
-        } else if (seg.is_italic) {
-            text_to_append = "*" + text_to_append + "*";
-        } else if (seg.is_bold) {
-            text_to_append = "**" + text_to_append + "**";
-        }
-        md_output_str += text_to_append;
-    }
-
-    // Regex replace for multiple spaces is good as a final cleanup
-    try {
-        md_output_str = std::regex_replace(md_output_str, std::regex(" {2,}"), " ");
-        // A very specific cleanup for " ** ** " or " * * " which might result from an empty text segment
-        // that only carried a formatting change. This is hard to get perfect without looking at segment formatting.
-        md_output_str = std::regex_replace(md_output_str, std::regex("\\*\\* \\*\\*"), ""); // ** ** -> ""
-        md_output_str = std::regex_replace(md_output_str, std::regex("\\* \\*"), "");       // * *   -> ""
-        md_output_str = trim_string_util(md_output_str);
-    } catch (const std::regex_error& e) {}
-
-    std::cout << md_output_str << std::endl;
-    std::cout << "------------------------\n";
-    std::flush(std::cout);
+    chunk_id = m_trace_last_chunk;
+    committed_us = m_trace_last_commit_us;
 }
 
 std::string DocumentFormatter::get_markdown_document() const {
     std::lock_guard<std::mutex> lock(m_doc_mutex);
-    std::string md_output_str = "";
-
-    for (size_t i = 0; i < m_document_segments.size(); ++i) {
-        const auto& seg = m_document_segments[i];
-
-        // 1) Copy the raw text…
-        std::string current_text = seg.text;
-
-        // 2) RIGHT-TRIM any trailing whitespace, exactly as you did in print…
-        while (!current_text.empty() &&
-               std::isspace((unsigned char)current_text.back())) {
-            current_text.pop_back();
-        }
-
-        // 3) Skip entirely if it’s empty and carries no formatting change
-        if (current_text.empty() && !(seg.is_bold || seg.is_italic)) {
-            continue;
-        }
-
-        // 4) Possibly insert a space before this new chunk:
-        if (!md_output_str.empty() && !current_text.empty()) {
-            if (md_output_str.back() != ' ') {
-                if (current_text.front() != ' ') {
-                    char last_char_of_md = ' ';
-                    if (!md_output_str.empty()) {
-                        for (long k_md = md_output_str.length() - 1; k_md >= 0; --k_md) {
-                            if (md_output_str[k_md] != '*' &&
-                                md_output_str[k_md] != '_') {
-                                last_char_of_md = md_output_str[k_md];
-                                break;
-                            }
-                            if (k_md == 0) last_char_of_md = md_output_str[k_md];
-                        }
-                    }
-                    char first_char_of_new = current_text.front();
-                    bool no_space_needed = (std::string(",.!?;:'\"").find(first_char_of_new) != std::string::npos)
-                                            || (std::string("([{\"*").find(last_char_of_md) != std::string::npos);
-                    if (!no_space_needed) {
-                        md_output_str += " ";
-                    }
-                }
-            }
-        }
-
-        // 5) Wrap in **…** / *…* / ***…*** if needed
-        std::string text_to_append = current_text;
-        if (seg.is_bold && seg.is_italic) {
-            text_to_append = "***" + text_to_append + "***";
-        } else if (seg.is_italic) {
-            text_to_append = "*" + text_to_append + "*";
-        } else if (seg.is_bold) {
-            text_to_append = "**" + text_to_append + "**";
-        }
-
-        md_output_str += text_to_append;
-    }
-
-    // 6) Final clean‐up (collapse multiple spaces to one, trim leading/trailing)
-    try {
-        md_output_str = std::regex_replace(md_output_str, std::regex(" {2,}"), " ");
-        md_output_str = trim_string_util(md_output_str);
-    } catch (const std::regex_error&) {
-        // ignore if regex fails
+    std::string md_output_str;
+    MarkdownBuilder builder;
+    for (const auto& seg : m_document_segments) {
+        builder.append_segment(seg, md_output_str);
     }
-
     return md_output_str;
 }
 
 void DocumentFormatter::save_document_to_file(const std::string& full_filename_path) const {
-    // std::cout << "--- SAVE COMMAND: Attempting to save to: " << full_filename_path << " ---" << std::endl;
-
-    // Get the MARKDOWN formatted document
-    std::string document_content_to_save = get_markdown_document();
-
-    fs::path output_file_p(full_filename_path);
-    fs::path output_dir_p = output_file_p.parent_path();
-
-    try {
-        if (!output_dir_p.empty() && !fs::exists(output_dir_p)) {
-            if (!fs::create_directories(output_dir_p)) {
-                std::cerr << "--- Error: Could not create directory " << output_dir_p.string() << " ---" << std::endl;
-                return;
-            }
-        }
-        std::ofstream outfile(output_file_p);
-        if (outfile.is_open()) {
-            outfile << document_content_to_save; // Save the Markdown content
-            outfile.close();
-            std::cout << "--- Document saved to " << fs::absolute(output_file_p).string() << " ---" << std::endl;
-        } else {
-            std::cerr << "--- Error: Could not open file " << output_file_p.string() << " for saving. ---" << std::endl;
-        }
-    } catch (const fs::filesystem_error& e) {
-        std::cerr << "--- Filesystem Error during save: " << e.what() << " ---" << std::endl;
-    }
+    std::vector<ExportTarget> targets;
+    targets.push_back({full_filename_path, find_export_format("md")->create()});
+    export_document(*this, targets);
 }
 
 void DocumentFormatter::signal_stop_application() {
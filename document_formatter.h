@@ -5,24 +5,62 @@
 #include <vector>
 #include <mutex>
 #include <atomic>
+#include <cstdint>
+#include <functional>
 #include "text_segment.h"
 
+// Voice commands recognised by the formatter, reported to the event listener in spoken order.
+enum class FormatEvent {
+    BoldOn,
+    BoldOff,
+    ItalicOn,
+    ItalicOff,
+    StopApplication
+};
+
 class DocumentFormatter {
 public:
     DocumentFormatter();
-    void process_transcribed_text(const std::string& text_from_whisper_raw);
-    void print_current_document_preview() const;
+    // words (optional) are the timed words of the text; they are matched to the words that end up
+    // in the document, so commands and cleaned-up artifacts simply go unmatched.
+    void process_transcribed_text(const std::string& text_from_whisper_raw, const std::vector<SpokenWord>& words = {});
     std::string get_markdown_document() const;
+    // Writes the Markdown and, when any word has a timing, its word index (path + WI_FILE_SUFFIX).
+    // Streams through document_exporter; see export_document() for other formats.
     void save_document_to_file(const std::string& full_filename_path) const;
     void signal_stop_application();
     void clear_document();
 
+    // Change tracking for readers that mirror the document (e.g. the preview renderer).
+    // The revision bumps on every change; the generation bumps when the document is cleared.
+    uint64_t get_revision() const { return m_revision.load(std::memory_order_acquire); }
+    // Copies segments [first_index, end) into out and returns the total segment count.
+    size_t copy_segments_from(size_t first_index, std::vector<TextSegment>& out, uint64_t& generation_out) const;
+    // As above, but copies at most max_count segments.
+    size_t copy_segments(size_t first_index, size_t max_count, std::vector<TextSegment>& out, uint64_t& generation_out) const;
+    // Called after every change, outside the document lock. Must be cheap and non-blocking.
+    void set_change_listener(std::function<void()> listener);
+    // Called for each recognised command after the text containing it has been applied.
+    void set_event_listener(std::function<void(FormatEvent)> listener);
+    // Tracing: the chunk whose text was committed last and when (trace clock); zeros if none.
+    void get_last_commit_trace(uint64_t& chunk_id, uint64_t& committed_us) const;
+
     std::atomic<bool> m_should_stop_application{false};
 
 private:
+    void notify_changed(const std::vector<FormatEvent>& events = {});
+    // Appends a text segment, taking timings for its words from words[next_word...].
+    void push_text_segment(const std::string& text, const std::vector<SpokenWord>& words, size_t& next_word);
+
     bool m_is_bold_active;
     bool m_is_italic_active;
     std::vector<TextSegment> m_document_segments;
     mutable std::mutex m_doc_mutex;
+    std::atomic<uint64_t> m_revision{0};
+    uint64_t m_generation = 0;
+    uint64_t m_trace_last_chunk = 0;
+    uint64_t m_trace_last_commit_us = 0;
+    std::function<void()> m_change_listener;
+    std::function<void(FormatEvent)> m_event_listener;
 };
 #endif // DOCUMENT_FORMATTER_H
\ No newline at end of file
@@ -0,0 +1,54 @@
+#include "energy_vad.h"
+#include <cmath>
+#include <algorithm>
+
+EnergyVad::EnergyVad(int sample_rate)
+    : m_frame_samples(std::max<size_t>(1, static_cast<size_t>(sample_rate * VAD_FRAME_SECONDS))) {}
+
+void EnergyVad::reset() {
+    m_frame_energy = 0.0;
+    m_frame_fill = 0;
+    m_samples_seen = 0;
+    m_have_floor = false;
+    m_loud_frames = 0;
+    m_run_start_sample = 0;
+}
+
+bool EnergyVad::finish_frame() {
+    double rms = std::sqrt(m_frame_energy / static_cast<double>(m_frame_samples));
+    double frame_db = 20.0 * std::log10(rms + 1e-9);
+    m_frame_energy = 0.0;
+    m_frame_fill = 0;
+
+    if (!m_have_floor) {
+        m_noise_floor_db = frame_db;
+        m_have_floor = true;
+    }
+    bool loud = frame_db > std::max(m_noise_floor_db + VAD_SPEECH_MARGIN_DB, VAD_MIN_SPEECH_DBFS);
+    // Follow the floor down immediately, up only slowly so speech does not become "noise".
+    if (frame_db < m_noise_floor_db) m_noise_floor_db = frame_db;
+    else if (!loud) m_noise_floor_db += 0.05 * (frame_db - m_noise_floor_db);
+
+    if (loud) {
+        if (m_loud_frames == 0) m_run_start_sample = m_samples_seen - m_frame_samples;
+        ++m_loud_frames;
+    } else {
+        m_loud_frames = 0;
+    }
+    return m_loud_frames >= VAD_ONSET_FRAMES;
+}
+
+bool EnergyVad::process(const float* samples, size_t count, uint64_t& onset_sample) {
+    bool detected = false;
+    for (size_t i = 0; i < count; ++i) {
+        double s = samples[i];
+        m_frame_energy += s * s;
+        ++m_frame_fill;
+        ++m_samples_seen;
+        if (m_frame_fill == m_frame_samples && finish_frame() && !detected) {
+            detected = true;
+            onset_sample = m_run_start_sample;
+        }
+    }
+    return detected;
+}
@@ -0,0 +1,37 @@
+#ifndef ENERGY_VAD_H
+#define ENERGY_VAD_H
+
+#include <cstddef>
+#include <cstdint>
+
+#define VAD_FRAME_SECONDS 0.02
+#define VAD_SPEECH_MARGIN_DB 10.0   // above the tracked noise floor
+#define VAD_MIN_SPEECH_DBFS -50.0   // never call anything quieter speech
+#define VAD_ONSET_FRAMES 3          // consecutive loud frames before speech is reported
+
+// Frame-energy voice activity detector with an adaptive noise floor. A few multiply-adds
+// per sample, so it can watch the input while the model sits idle.
+class EnergyVad {
+public:
+    explicit EnergyVad(int sample_rate);
+
+    void reset();
+    // Feeds samples in stream order. Returns true once speech is detected and sets
+    // onset_sample to the stream position (counted from the last reset) where it began.
+    bool process(const float* samples, size_t count, uint64_t& onset_sample);
+    uint64_t samples_seen() const { return m_samples_seen; }
+
+private:
+    bool finish_frame();
+
+    size_t m_frame_samples;
+    double m_frame_energy = 0.0;
+    size_t m_frame_fill = 0;
+    uint64_t m_samples_seen = 0;
+    double m_noise_floor_db = 0.0;
+    bool m_have_floor = false;
+    int m_loud_frames = 0;
+    uint64_t m_run_start_sample = 0;
+};
+
+#endif // ENERGY_VAD_H
@@ -0,0 +1,165 @@
+// index_main.cpp - looks up words of a saved document in its word index (<document>.idx).
+//   voxformat_index DOCUMENT.md [--offset N]... [--time T]... [--context N]
+// T is seconds, or [h:]mm:ss[.fff]. Only the looked-up words are read from the document.
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <charconv>
+#include <limits>
+#include <filesystem>
+#include "word_index.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+void print_index_usage(const char* program_name) {
+    std::cout << "Usage: " << program_name << " DOCUMENT.md [--offset N]... [--time T]... [--context N]\n"
+              << "  --offset N   Audio time of the word at byte offset N of the document\n"
+              << "  --time T     Word spoken at T (seconds, or [h:]mm:ss[.fff]) and its offset in the document\n"
+              << "  --context N  Also show N words either side (default 3)\n"
+              << "Without a lookup, prints the number of indexed words and the audio they cover.\n";
+}
+
+// Decimal digits only, within uint64_t. Returns false on anything else.
+bool parse_count(const std::string& text, uint64_t& value) {
+    const char* end = text.data() + text.size();
+    auto [parsed_end, error] = std::from_chars(text.data(), end, value);
+    return !text.empty() && error == std::errc() && parsed_end == end;
+}
+
+// Seconds, or colon-separated [h:]mm:ss[.fff]. Returns false on anything else.
+bool parse_time_ms(const std::string& text, uint32_t& time_ms) {
+    double seconds = 0.0;
+    std::stringstream in(text);
+    std::string part;
+    while (std::getline(in, part, ':')) {
+        size_t used = 0;
+        double value = 0.0;
+        try {
+            value = std::stod(part, &used);
+        } catch (const std::exception&) {
+            return false;
+        }
+        if (used != part.size() || value < 0.0) return false;
+        seconds = seconds * 60.0 + value;
+    }
+    if (seconds * 1000.0 > std::numeric_limits<uint32_t>::max()) return false;
+    time_ms = static_cast<uint32_t>(seconds * 1000.0 + 0.5);
+    return true;
+}
+
+std::string format_time(uint32_t time_ms) {
+    std::ostringstream out;
+    out << time_ms / 3600000 << ':' << std::setfill('0') << std::setw(2) << time_ms / 60000 % 60 << ':'
+        << std::setw(2) << time_ms / 1000 % 60 << '.' << std::setw(3) << time_ms % 1000;
+    return out.str();
+}
+
+std::string read_range(std::ifstream& document, uint64_t offset, uint64_t length) {
+    std::string text(static_cast<size_t>(length), '\0');
+    document.clear();
+    document.seekg(static_cast<std::streamoff>(offset));
+    document.read(text.data(), static_cast<std::streamsize>(length));
+    text.resize(static_cast<size_t>(document.gcount()));
+    return text;
+}
+
+// The words around `word` as they appear in the document, with the word itself in brackets.
+void print_word(const WordIndexReader& index, std::ifstream& document, size_t word, size_t context) {
+    WordIndexEntry entry = index.entry(word);
+    size_t first = word >= context ? word - context : 0;
+    size_t last = word + std::min(context, index.size() - 1 - word);
+    WordIndexEntry first_entry = index.entry(first);
+    WordIndexEntry last_entry = index.entry(last);
+    std::string before = read_range(document, first_entry.text_offset, entry.text_offset - first_entry.text_offset);
+    std::string text = read_range(document, entry.text_offset, entry.text_length);
+    uint64_t after_start = static_cast<uint64_t>(entry.text_offset) + entry.text_length;
+    std::string after = read_range(document, after_start, last_entry.text_offset + last_entry.text_length - after_start);
+    std::cout << "  offset " << entry.text_offset << ", " << format_time(entry.start_ms) << " - " << format_time(entry.end_ms)
+              << ": ..." << before << '[' << text << ']' << after << "...\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2 || std::string(argv[1]) == "--help" || std::string(argv[1]) == "-h") {
+        print_index_usage(argv[0]);
+        return argc < 2 ? 1 : 0;
+    }
+    const std::string document_path = argv[1];
+    std::vector<std::pair<std::string, std::string>> lookups;
+    size_t context = 3;
+    for (int i = 2; i < argc; ++i) {
+        std::string key = argv[i];
+        if ((key != "--offset" && key != "--time" && key != "--context") || i + 1 >= argc) {
+            std::cerr << "Index: Unexpected argument '" << key << "'" << std::endl;
+            print_index_usage(argv[0]);
+            return 1;
+        }
+        std::string value = argv[++i];
+        uint64_t count = 0;
+        if (key != "--time" && !parse_count(value, count)) {
+            std::cerr << "Index: Invalid number '" << value << "' for " << key << std::endl;
+            print_index_usage(argv[0]);
+            return 1;
+        }
+        if (key == "--context") {
+            context = static_cast<size_t>(std::min<uint64_t>(count, std::numeric_limits<size_t>::max()));
+        } else {
+            lookups.emplace_back(key, value);
+        }
+    }
+
+    WordIndexReader index;
+    if (!index.open(document_path + WI_FILE_SUFFIX)) return 1;
+    std::ifstream document(document_path, std::ios::binary);
+    if (!document.is_open()) {
+        std::cerr << "Index: Could not open " << document_path << std::endl;
+        return 1;
+    }
+    std::error_code ec;
+    if (fs::file_size(document_path, ec) != index.document_bytes()) {
+        std::cerr << "Index: " << document_path << " has changed since it was indexed; offsets may be wrong." << std::endl;
+    }
+
+    if (lookups.empty()) {
+        std::cout << index.size() << " word(s) indexed";
+        if (index.size() > 0) {
+            std::cout << ", " << format_time(index.entry(0).start_ms) << " to "
+                      << format_time(index.entry(index.size() - 1).end_ms);
+        }
+        std::cout << std::endl;
+        return 0;
+    }
+    int status = 0;
+    for (const auto& [key, value] : lookups) {
+        size_t word = WordIndexReader::npos;
+        if (key == "--offset") {
+            std::cout << "Offset " << value << ":\n";
+            uint64_t offset = 0;
+            parse_count(value, offset); // validated with the arguments
+            word = index.find_by_offset(offset);
+        } else {
+            uint32_t time_ms = 0;
+            if (!parse_time_ms(value, time_ms)) {
+                std::cerr << "Index: Invalid time '" << value << "'" << std::endl;
+                status = 1;
+                continue;
+            }
+            std::cout << "Time " << format_time(time_ms) << ":\n";
+            word = index.find_by_time(time_ms);
+        }
+        if (word == WordIndexReader::npos) {
+            std::cout << "  no word\n";
+            continue;
+        }
+        print_word(index, document, word, context);
+    }
+    return status;
+}
@@ -0,0 +1,57 @@
+#include "inference_pool.h"
+#include <algorithm>
+#include "pipeline_trace.h"
+
+InferencePool::InferencePool(int worker_count, int threads_per_job)
+    : m_threads_per_job(std::max(1, threads_per_job)) {
+    worker_count = std::max(1, worker_count);
+    for (int i = 0; i < worker_count; ++i) {
+        m_workers.emplace_back(&InferencePool::worker_loop, this);
+    }
+}
+
+InferencePool::~InferencePool() {
+    {
+        std::lock_guard<std::mutex> lock(m_queue_mutex);
+        m_stopping = true;
+    }
+    m_queue_cv.notify_all();
+    for (auto& worker : m_workers) {
+        if (worker.joinable()) worker.join();
+    }
+}
+
+int InferencePool::default_threads_per_job(int worker_count) {
+    int hardware_threads = static_cast<int>(std::thread::hardware_concurrency());
+    if (hardware_threads <= 0) hardware_threads = 4;
+    return std::max(1, hardware_threads / std::max(1, worker_count));
+}
+
+int InferencePool::run(std::function<int()> job) {
+    std::packaged_task<int()> task(std::move(job));
+    std::future<int> result = task.get_future();
+    {
+        std::lock_guard<std::mutex> lock(m_queue_mutex);
+        m_queue.push_back(std::move(task));
+    }
+    m_queue_cv.notify_one();
+    return result.get();
+}
+
+void InferencePool::worker_loop() {
+#if defined(VOXFORMAT_ENABLE_TRACING)
+    PipelineTrace::set_thread_name("inference-pool");
+#endif
+    while (true) {
+        std::packaged_task<int()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_queue_mutex);
+            m_queue_cv.wait(lock, [&]{ return m_stopping || !m_queue.empty(); });
+            if (m_queue.empty()) return; // stopping and drained
+            task = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+        task();
+        m_jobs_completed.fetch_add(1, std::memory_order_relaxed);
+    }
+}
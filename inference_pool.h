@@ -0,0 +1,47 @@
+#ifndef INFERENCE_POOL_H
+#define INFERENCE_POOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <cstdint>
+#include <atomic>
+
+// Fixed set of threads that run whisper decodes for many processors, so the number of
+// concurrent decodes (and their thread counts) is bounded no matter how many streams exist.
+class InferencePool {
+public:
+    // threads_per_job is what each decode should pass as whisper_full_params::n_threads.
+    InferencePool(int worker_count, int threads_per_job);
+    ~InferencePool();
+
+    InferencePool(const InferencePool&) = delete;
+    InferencePool& operator=(const InferencePool&) = delete;
+
+    // Runs job on a pool thread and blocks the caller until it has finished.
+    int run(std::function<int()> job);
+
+    int worker_count() const { return static_cast<int>(m_workers.size()); }
+    int threads_per_job() const { return m_threads_per_job; }
+    uint64_t jobs_completed() const { return m_jobs_completed.load(std::memory_order_relaxed); }
+
+    // Splits the machine's hardware threads between worker_count concurrent decodes.
+    static int default_threads_per_job(int worker_count);
+
+private:
+    void worker_loop();
+
+    int m_threads_per_job;
+    std::vector<std::thread> m_workers;
+    std::deque<std::packaged_task<int()>> m_queue;
+    std::mutex m_queue_mutex;
+    std::condition_variable m_queue_cv;
+    bool m_stopping = false;
+    std::atomic<uint64_t> m_jobs_completed{0};
+};
+
+#endif // INFERENCE_POOL_H
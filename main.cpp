@@ -5,102 +5,421 @@
 #include <thread>
 #include <chrono>
 #include <atomic>
-#include <mutex>
-#include <condition_variable>
 #include <filesystem>
+#include <memory>
+#include <algorithm>
+#include <csignal>
 
 #include "audio_capturer.h"
-#include "whisper_processor.h" // This will bring in WP_CHUNK_PROCESSING_SECONDS (if it's a macro)
-                              // or WhisperProcessor::CFG_PROCESSING_WINDOW_SECONDS (if static const)
+#include "inference_pool.h"
+#include "whisper_model.h"
+#include "whisper_processor.h" // WP_PROCESSING_WINDOW_SECONDS_VAL
+#include "vox_session.h"
 #include "document_formatter.h"
+#include "preview_renderer.h"
+#include "app_options.h"
+#include "model_selector.h"
 #include "text_segment.h"
+#include "pipeline_trace.h"
+#include "session_recorder.h"
+#include "transcript_cache.h"
+#include "document_exporter.h"
 
 namespace fs = std::filesystem;
 
-std::vector<float> g_main_shared_audio_buffer;
-std::mutex g_main_document_and_audio_mutex;
-std::condition_variable g_main_buffer_cv;
-std::atomic<bool> g_main_stop_threads{false};
-
-const int SILENCE_TIMEOUT_SECONDS = 30;
 // #define APP_RECORDING_DURATION_SECONDS 30 // No longer used for fixed duration
 
-int main() {
-    g_main_stop_threads.store(false);
-    DocumentFormatter doc_formatter;
-
-    // const char* model_path = "../external/whisper.cpp/models/ggml-base.en.bin";
-    const char* model_path = "../external/whisper.cpp/models/ggml-small.en.bin";
-    // const char* model_path = "../external/whisper.cpp/models/ggml-medium.en.bin";
-    WhisperProcessor whisper_processor(model_path,
-                                       g_main_shared_audio_buffer,
-                                       g_main_document_and_audio_mutex,
-                                       g_main_buffer_cv,
-                                       g_main_stop_threads,
-                                       doc_formatter);
-    if (!whisper_processor.initialize_whisper()) {
+// Set from the signal handler; the main loop writes the trace on its next tick.
+static volatile std::sig_atomic_t g_trace_dump_requested = 0;
+#if defined(SIGUSR1)
+static void request_trace_dump(int) { g_trace_dump_requested = 1; }
+#endif
+
+static void write_trace(const std::string& path) {
+    if (PipelineTrace::write_chrome_trace(path)) {
+        std::cout << "--- Trace written to " << fs::absolute(path).string() << " ---" << std::endl;
+    }
+}
+
+static void print_processor_metrics(const ProcessorMetrics& metrics) {
+    auto cpu_percent = [](double cpu_seconds, double wall_seconds) {
+        return wall_seconds > 0.0 ? 100.0 * cpu_seconds / wall_seconds : 0.0;
+    };
+    std::cout << "--- Metrics ---\n"
+              << "Chunks processed: " << metrics.chunks_processed << "\n"
+              << "Samples dropped (worker behind): " << metrics.dropped_samples << "\n"
+              << "Chunk processing: avg " << (metrics.chunks_processed > 0 ? 1000.0 * metrics.total_chunk_seconds / static_cast<double>(metrics.chunks_processed) : 0.0)
+              << " ms, max " << 1000.0 * metrics.max_chunk_seconds << " ms\n"
+              << "Active: " << metrics.active_seconds << "s, process CPU " << cpu_percent(metrics.active_cpu_seconds, metrics.active_seconds) << "% of one core\n"
+              << "Idle: " << metrics.idle_seconds << "s over " << metrics.idle_entries << " period(s), process CPU "
+              << cpu_percent(metrics.idle_cpu_seconds, metrics.idle_seconds) << "% of one core\n";
+    if (metrics.resumes > 0) {
+        std::cout << "Resume latency: last " << metrics.last_resume_latency_ms << " ms, avg "
+                  << metrics.total_resume_latency_ms / static_cast<double>(metrics.resumes) << " ms, max "
+                  << metrics.max_resume_latency_ms << " ms\n";
+    }
+    std::cout << "---------------" << std::endl;
+}
+
+static std::shared_ptr<TranscriptCache> open_transcript_cache(const AppOptions& options) {
+    if (options.cache_dir.empty()) return nullptr;
+    return TranscriptCache::open(options.cache_dir, static_cast<uint64_t>(options.cache_max_megabytes) * 1024 * 1024);
+}
+
+static void print_cache_stats(const TranscriptCache& cache) {
+    TranscriptCacheStats stats = cache.stats();
+    uint64_t lookups = stats.hits + stats.misses;
+    std::cout << "Transcript cache (" << cache.directory() << "): " << stats.hits << " hit(s), " << stats.misses << " miss(es)";
+    if (lookups > 0) std::cout << ", " << 100.0 * static_cast<double>(stats.hits) / static_cast<double>(lookups) << "% hit rate";
+    std::cout << "; " << stats.stores << " stored, " << stats.evictions << " evicted, "
+              << stats.bytes_on_disk / 1024 << " KiB on disk" << std::endl;
+}
+
+static std::string profile_path_for(const AppOptions& options) {
+    return options.profile_path.empty() ? default_profile_path() : options.profile_path;
+}
+
+static int run_calibration_command(const AppOptions& options) {
+    std::vector<ModelCandidate> candidates = discover_models(options.models_dir);
+    if (candidates.empty()) {
+        std::cerr << "Main: No ggml-*.bin models found in " << options.models_dir << std::endl;
+        return 1;
+    }
+    bool synthetic = false;
+    std::vector<float> audio = load_calibration_audio(options.fixtures_dir, options.calibration_seconds, &synthetic);
+    CalibrationProfile profile = run_calibration(candidates, audio, options.calibration_seconds);
+    profile.synthetic_audio = synthetic;
+    if (profile.entries.empty()) {
+        std::cerr << "Main: Calibration produced no results." << std::endl;
+        return 1;
+    }
+    std::string profile_path = profile_path_for(options);
+    if (!save_calibration_profile(profile_path, profile)) return 1;
+    std::cout << "Calibration profile saved to " << profile_path << std::endl;
+    if (synthetic) {
+        std::cout << "These RTFs were measured on synthetic audio; put WAV recordings in " << options.fixtures_dir
+                  << " (or pass --fixtures DIR) and calibrate again for representative numbers." << std::endl;
+    }
+    std::string chosen = select_model_from_profile(profile, options.target_rtf);
+    if (!chosen.empty()) std::cout << "Model for target RTF " << options.target_rtf << ": " << chosen << std::endl;
+    return 0;
+}
+
+// Explicit --model wins; otherwise the calibration profile for this host decides.
+static std::string resolve_model_path(const AppOptions& options) {
+    std::string fallback_path = (fs::path(options.models_dir) / MS_DEFAULT_MODEL_FILE).string();
+    if (!options.model_path.empty()) return options.model_path;
+
+    CalibrationProfile profile;
+    std::string profile_path = profile_path_for(options);
+    if (!load_calibration_profile(profile_path, profile)) {
+        std::cout << "No calibration profile at " << profile_path << "; using " << fallback_path
+                  << " (run with --calibrate to pick a model for this host)." << std::endl;
+        return fallback_path;
+    }
+    if (profile.host_key != current_host_key()) {
+        std::cout << "Calibration profile was recorded on a different host; using " << fallback_path
+                  << " (run with --calibrate to refresh it)." << std::endl;
+        return fallback_path;
+    }
+    // The RTFs only hold for the thread count they were measured with.
+    int decode_threads = WhisperModel::default_decode_params().n_threads;
+    if (profile.threads != decode_threads) {
+        std::cout << "Calibration profile was measured with " << profile.threads << " decode thread(s), now "
+                  << decode_threads << "; using " << fallback_path << " (run with --calibrate to refresh it)." << std::endl;
+        return fallback_path;
+    }
+    std::string selected = select_model_from_profile(profile, options.target_rtf);
+    if (selected.empty()) {
+        std::cout << "No calibrated model is available any more; using " << fallback_path << std::endl;
+        return fallback_path;
+    }
+    std::cout << "Selected model " << selected << " from calibration profile"
+              << (profile.synthetic_audio ? " (measured on synthetic audio)." : ".") << std::endl;
+    return selected;
+}
+
+// Feeds a recording back through decode and commit, bypassing capture and chunking, and
+// reports every chunk whose transcript differs from the recorded one. Exit code 2 on differences.
+static int run_replay_command(const AppOptions& options) {
+    SessionRecordingReader reader;
+    if (!reader.open(options.replay_path)) return 1;
+    if (reader.sample_rate() != WP_WHISPER_SAMPLE_RATE) {
+        std::cerr << "Main: Recording is at " << reader.sample_rate() << " Hz, expected " << WP_WHISPER_SAMPLE_RATE << " Hz." << std::endl;
+        return 1;
+    }
+    std::string model_path = options.model_path;
+    if (model_path.empty() && !reader.model_path().empty() && fs::exists(reader.model_path())) model_path = reader.model_path();
+    if (model_path.empty()) {
+        model_path = resolve_model_path(options);
+        std::cout << "Recorded model " << reader.model_path() << " is not available; transcripts may differ." << std::endl;
+    }
+    std::shared_ptr<WhisperModel> model = WhisperModel::load(model_path, true);
+    if (!model) return 1;
+
+    DocumentFormatter formatter;
+    std::vector<FormatEvent> replayed_events;
+    formatter.set_event_listener([&](FormatEvent event) { replayed_events.push_back(event); });
+    WhisperProcessor processor(model, formatter, WP_WHISPER_SAMPLE_RATE);
+    std::shared_ptr<TranscriptCache> cache = open_transcript_cache(options);
+    if (!options.cache_dir.empty() && !cache) return 1;
+    processor.set_transcript_cache(cache);
+    processor.set_word_timestamps(options.word_index);
+    // whisper's float reductions depend on the thread count, so decode with the session's.
+    const int default_threads = WhisperModel::default_decode_params().n_threads;
+    const int decode_threads = reader.decode_threads() > 0 ? reader.decode_threads() : default_threads;
+    if (decode_threads != default_threads) processor.set_inference_pool(std::make_shared<InferencePool>(1, decode_threads));
+    if (!processor.initialize_whisper()) return 1;
+
+    std::cout << "Replaying " << options.replay_path << " with " << model_path << ", " << decode_threads << " decode thread(s)"
+              << (reader.decode_threads() > 0 ? "" : " (not recorded)") << std::endl;
+    std::vector<FormatEvent> recorded_events;
+    std::string recorded_document;
+    bool have_document = false;
+    uint64_t replayed_chunk = 0;
+    std::string replayed_text;
+    size_t chunks = 0, mismatches = 0;
+    double audio_seconds = 0.0, decode_seconds = 0.0, slowest_seconds = 0.0;
+    uint64_t slowest_chunk = 0;
+
+    SessionRecord record;
+    while (reader.next(record)) {
+        switch (record.type) {
+            case SessionRecordType::Chunk: {
+                double chunk_audio_seconds = static_cast<double>(record.samples.size()) / WP_WHISPER_SAMPLE_RATE;
+                auto start = std::chrono::steady_clock::now();
+                replayed_text = processor.replay_chunk(record.samples, record.window_start_ms);
+                double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                replayed_chunk = record.chunk_index;
+                ++chunks;
+                audio_seconds += chunk_audio_seconds;
+                decode_seconds += elapsed;
+                if (elapsed > slowest_seconds) { slowest_seconds = elapsed; slowest_chunk = record.chunk_index; }
+                break;
+            }
+            case SessionRecordType::Transcript:
+                if (record.chunk_index == replayed_chunk && record.text != replayed_text) {
+                    ++mismatches;
+                    std::cout << "Chunk " << record.chunk_index << " differs:\n  recorded: " << record.text
+                              << "\n  replayed: " << replayed_text << std::endl;
+                }
+                break;
+            case SessionRecordType::Format:
+                recorded_events.push_back(record.format);
+                break;
+            case SessionRecordType::Document:
+                recorded_document = record.text;
+                have_document = true;
+                break;
+            case SessionRecordType::Audio: // consumed by the reader, never returned
+                break;
+        }
+    }
+
+    std::string replayed_document = formatter.get_markdown_document();
+    bool events_match = recorded_events == replayed_events;
+    bool document_matches = !have_document || recorded_document == replayed_document;
+    std::cout << "--- Replay ---\n"
+              << "Chunks: " << chunks << " (" << audio_seconds << "s of audio)\n"
+              << "Decode time: " << decode_seconds << "s, RTF " << (audio_seconds > 0.0 ? decode_seconds / audio_seconds : 0.0)
+              << ", slowest chunk " << slowest_chunk << " (" << slowest_seconds << "s)\n"
+              << "Transcript mismatches: " << mismatches << "\n"
+              << "Commands: " << (events_match ? "identical" : "differ") << " (" << recorded_events.size() << " recorded, "
+              << replayed_events.size() << " replayed)\n"
+              << "Document: " << (have_document ? (document_matches ? "identical" : "differs") : "not in recording (session did not finish)") << "\n";
+    if (reader.missing_samples() > 0) {
+        std::cout << "Missing audio: " << static_cast<double>(reader.missing_samples()) / WP_WHISPER_SAMPLE_RATE
+                  << "s (records dropped while recording), replayed as silence\n";
+    }
+    if (reader.sample_format() == RecordedSampleFormat::Int16) {
+        std::cout << "Note: s16 recording. The live session decoded the unrounded samples, so replay is approximate;\n"
+                  << "      record with --record-format f32 for a bit-exact replay.\n";
+    }
+    std::cout << "--------------" << std::endl;
+    if (cache) print_cache_stats(*cache);
+    fs::path output_dir_path = fs::current_path().parent_path() / "outputs";
+    export_document(formatter, (output_dir_path / "replay").string(), options.export_formats);
+    return (mismatches == 0 && events_match && document_matches) ? 0 : 2;
+}
+
+// session.voxrec -> session-dev3-ch0.voxrec when several streams are recorded.
+static std::string stream_record_path(const std::string& record_path, const std::string& stream_label, bool several_streams) {
+    if (!several_streams) return record_path;
+    fs::path path(record_path);
+    return (path.parent_path() / (path.stem().string() + "-" + stream_label + path.extension().string())).string();
+}
+
+int main(int argc, char** argv) {
+    AppOptions options;
+    if (!parse_app_options(argc, argv, options)) {
+        print_app_usage(argv[0]);
+        return 1;
+    }
+    if (options.show_help) {
+        print_app_usage(argv[0]);
+        return 0;
+    }
+
+    if (options.calibrate) {
+        return run_calibration_command(options);
+    }
+
+    if (options.list_devices) {
+        AudioCapturer::list_input_devices();
+        return 0;
+    }
+
+    if (!options.replay_path.empty()) {
+        return run_replay_command(options);
+    }
+
+    if (!options.trace_path.empty()) {
+#if defined(VOXFORMAT_ENABLE_TRACING)
+        PipelineTrace::enable();
+        PipelineTrace::set_thread_name("main");
+#if defined(SIGUSR1)
+        std::signal(SIGUSR1, request_trace_dump);
+#endif
+#else
+        std::cerr << "Main: This build has tracing compiled out (VOXFORMAT_TRACING=OFF); --trace is ignored." << std::endl;
+        options.trace_path.clear();
+#endif
+    }
+
+    std::vector<CaptureDeviceSpec> devices = options.devices;
+    if (devices.empty()) devices.push_back(CaptureDeviceSpec{});
+    size_t stream_count = 0;
+    for (const auto& device : devices) stream_count += static_cast<size_t>(device.channels);
+
+    std::string model_path = resolve_model_path(options);
+    std::shared_ptr<WhisperModel> model = WhisperModel::load(model_path, true);
+    if (!model) {
         std::cerr << "Main: Failed to initialize Whisper. Exiting." << std::endl;
         return 1;
     }
 
-    AudioCapturer audio_capturer(g_main_shared_audio_buffer,
-                                 g_main_document_and_audio_mutex,
-                                 g_main_buffer_cv,
-                                 g_main_stop_threads);
+    // All streams share the model weights and one pool of decode workers.
+    std::shared_ptr<InferencePool> inference_pool;
+    if (stream_count > 1 || options.inference_workers > 0) {
+        int hardware_threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        int workers = options.inference_workers > 0 ? options.inference_workers
+                                                    : std::min(static_cast<int>(stream_count), hardware_threads);
+        inference_pool = std::make_shared<InferencePool>(workers, InferencePool::default_threads_per_job(workers));
+    }
+    const int decode_threads = inference_pool ? inference_pool->threads_per_job() : WhisperModel::default_decode_params().n_threads;
+
+    VoxSessionConfig session_config;
+    session_config.input_sample_rate = AC_INPUT_SAMPLE_RATE;
+    session_config.event_callback = [](const VoxEvent&) {}; // the app reads the document directly
+    session_config.idle_after = std::chrono::seconds(options.idle_after_seconds);
+    session_config.word_timestamps = options.word_index;
+    session_config.inference_pool = inference_pool;
+    session_config.transcript_cache = open_transcript_cache(options);
+    if (!options.cache_dir.empty() && !session_config.transcript_cache) return 1;
+
+    std::vector<std::unique_ptr<VoxSession>> sessions;
+    std::vector<std::string> stream_labels;
+    std::vector<std::shared_ptr<SessionRecorder>> recorders;
+    std::vector<AudioCapturer::ChannelSink> sinks;
+    for (const auto& device : devices) {
+        for (int channel = 0; channel < device.channels; ++channel) {
+            std::string device_label = device.device == paNoDevice ? "default" : std::to_string(device.device);
+            std::string stream_label = "dev" + device_label + "-ch" + std::to_string(channel);
+            VoxSessionConfig stream_config = session_config;
+            if (!options.record_path.empty()) {
+                stream_config.recorder = SessionRecorder::open(stream_record_path(options.record_path, stream_label, stream_count > 1),
+                                                               options.record_format, model_path, decode_threads);
+                if (!stream_config.recorder) return 1;
+                recorders.push_back(stream_config.recorder);
+            }
+            std::unique_ptr<VoxSession> session = VoxSession::create(model, stream_config);
+            if (!session) {
+                std::cerr << "Main: Failed to initialize Whisper. Exiting." << std::endl;
+                return 1;
+            }
+            VoxSession* session_ptr = session.get();
+            sinks.push_back([session_ptr](const float* samples, size_t frames, size_t stride) {
+                session_ptr->push_pcm_strided(samples, frames, stride);
+            });
+            stream_labels.push_back(stream_label);
+            sessions.push_back(std::move(session));
+        }
+    }
+
+    // A single terminal can only show one live document.
+    std::unique_ptr<PreviewRenderer> preview_renderer;
+    if (options.show_preview && sessions.size() == 1) {
+        DocumentFormatter& doc_formatter = sessions.front()->formatter();
+        preview_renderer = std::make_unique<PreviewRenderer>(doc_formatter, std::cout, options.preview_fps);
+        doc_formatter.set_change_listener([renderer = preview_renderer.get()]{ renderer->request_frame(); });
+    } else if (options.show_preview) {
+        std::cout << "Transcribing " << sessions.size() << " streams; live preview is disabled." << std::endl;
+    }
+
+    AudioCapturer audio_capturer(devices, sinks);
     if (!audio_capturer.initialize()) {
         std::cerr << "Main: Failed to initialize Audio Capturer. Exiting." << std::endl;
         return 1;
     }
 
-    whisper_processor.start_processing_thread();
+    if (preview_renderer) preview_renderer->start();
     if (!audio_capturer.start_stream()) {
         std::cerr << "Main: Failed to start audio stream. Signaling stop." << std::endl;
-        g_main_stop_threads.store(true);
-        g_main_buffer_cv.notify_all();
-        if(whisper_processor.is_thread_joinable()) whisper_processor.join_thread();
+        for (auto& session : sessions) session->finish();
+        if (preview_renderer) preview_renderer->stop();
         return 1;
     }
 
     std::cout << "Whisper model loaded. VoxFormat ready." << std::endl;
     // Use the constant defined in whisper_processor.h directly as it's a macro now
     std::cout << "Speak your commands and text. Processing " << WP_PROCESSING_WINDOW_SECONDS_VAL /* Use the macro directly */ << "s audio chunks." << std::endl;
-    std::cout << "--- Listening... (Application will stop after " << SILENCE_TIMEOUT_SECONDS << "s of silence or by 'format stop application') ---" << std::endl;
+    if (options.silence_timeout_seconds > 0) {
+        std::cout << "--- Listening... (Application will stop after " << options.silence_timeout_seconds << "s of silence or by 'format stop application') ---" << std::endl;
+    } else {
+        std::cout << "--- Listening... (Application will stop on 'format stop application') ---" << std::endl;
+    }
 
     while(true) {
         std::this_thread::sleep_for(std::chrono::seconds(1));
 
-        if (g_main_stop_threads.load(std::memory_order_acquire)) {
-             if (doc_formatter.m_should_stop_application.load(std::memory_order_acquire)){
-                 // Message already printed by DocumentFormatter or main loop when command detected
-             } else {
-                 std::cout << "\n--- Main: Stop signal received by main loop. Initiating shutdown... ---" << std::endl;
-             }
-            break;
+        if (g_trace_dump_requested) {
+            g_trace_dump_requested = 0;
+            write_trace(options.trace_path);
+        }
+
+        bool stop_command = false;
+        bool stop_signal = false;
+        auto last_speech_activity = std::chrono::steady_clock::time_point::min();
+        for (auto& session : sessions) {
+            stop_command = stop_command || session->formatter().m_should_stop_application.load(std::memory_order_acquire);
+            stop_signal = stop_signal || session->processor().stop_requested();
+            last_speech_activity = std::max(last_speech_activity, session->processor().get_last_activity_time());
         }
 
-        if (doc_formatter.m_should_stop_application.load(std::memory_order_acquire)) {
+        if (stop_command) {
             std::cout << "\n--- Main: 'format stop application' detected by formatter. Signaling all threads... ---" << std::endl;
-            g_main_stop_threads.store(true, std::memory_order_release);
-            g_main_buffer_cv.notify_all();
+            break;
+        }
+
+        if (stop_signal) {
+            std::cout << "\n--- Main: Stop signal received by main loop. Initiating shutdown... ---" << std::endl;
             break;
         }
 
         auto now = std::chrono::steady_clock::now();
-        auto last_speech_activity = whisper_processor.get_last_activity_time();
         auto silence_duration = std::chrono::duration_cast<std::chrono::seconds>(now - last_speech_activity);
 
-        if (silence_duration.count() >= SILENCE_TIMEOUT_SECONDS) {
-            std::cout << "\n--- Main: " << SILENCE_TIMEOUT_SECONDS << "s of silence detected. Signaling stop... ---" << std::endl;
-            g_main_stop_threads.store(true, std::memory_order_release);
-            g_main_buffer_cv.notify_all();
+        if (options.silence_timeout_seconds > 0 && silence_duration.count() >= options.silence_timeout_seconds) {
+            std::cout << "\n--- Main: " << options.silence_timeout_seconds << "s of silence detected. Signaling stop... ---" << std::endl;
             break;
         }
     }
 
     audio_capturer.stop_stream();
-
-    if (whisper_processor.is_thread_joinable()) {
-        whisper_processor.join_thread();
+    for (auto& session : sessions) session->finish();
+    if (preview_renderer) {
+        sessions.front()->formatter().set_change_listener(nullptr);
+        preview_renderer->stop();
     }
 
     fs::path project_run_path = fs::current_path(); // This is cmake-build-debug
@@ -110,10 +429,19 @@ int main() {
     // project_root_path = source_file_dir; // Assuming main.cpp is in project root
 
     fs::path output_dir_path = project_root_path / "outputs";
-    std::string output_file_path_str = (output_dir_path / "output.md").string();
-
-    doc_formatter.save_document_to_file(output_file_path_str);
+    for (size_t i = 0; i < sessions.size(); ++i) {
+        std::string file_name = sessions.size() == 1 ? "output" : "output-" + stream_labels[i];
+        export_document(sessions[i]->formatter(), (output_dir_path / file_name).string(), options.export_formats);
+        if (sessions.size() > 1) std::cout << "[" << stream_labels[i] << "] ";
+        print_processor_metrics(sessions[i]->processor().get_metrics());
+    }
 
+    if (session_config.transcript_cache) print_cache_stats(*session_config.transcript_cache);
+    for (const auto& recorder : recorders) {
+        std::cout << "--- Session recorded to " << fs::absolute(recorder->path()).string() << " ("
+                  << recorder->bytes_written() / 1024 << " KiB); replay with --replay ---" << std::endl;
+    }
+    if (!options.trace_path.empty()) write_trace(options.trace_path);
     std::cout << "Application finished." << std::endl;
     return 0;
-}
\ No newline at end of file
+}
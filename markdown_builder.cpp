@@ -0,0 +1,66 @@
+#include "markdown_builder.h"
+#include <cctype>
+#include <cstdint>
+
+void MarkdownBuilder::put(std::string& out, char c) {
+    out.push_back(c);
+    m_state.empty = false;
+    m_state.last_char = c;
+    if (c != '*' && c != '_') m_state.last_text_char = c;
+}
+
+bool MarkdownBuilder::append_segment(const TextSegment& seg, std::string& out, size_t* text_offset,
+                                     std::vector<size_t>* word_offsets) {
+    size_t text_len = seg.text.size();
+    while (text_len > 0 && std::isspace(static_cast<unsigned char>(seg.text[text_len - 1]))) {
+        --text_len;
+    }
+    size_t text_start = 0;
+    while (text_start < text_len && seg.text[text_start] == ' ') {
+        ++text_start;
+    }
+    if (text_start >= text_len) {
+        // Unformatted blank segments produce nothing. A formatted one still produces its empty
+        // marker pair ("****" for bold), as the document has always been saved.
+        if (!seg.is_bold && !seg.is_italic) return false;
+        const char* empty_marker = seg.is_bold && seg.is_italic ? "******" : (seg.is_bold ? "****" : "**");
+        if (text_offset) *text_offset = out.size();
+        if (word_offsets) word_offsets->assign(seg.words.size(), SIZE_MAX);
+        for (const char* m = empty_marker; *m; ++m) put(out, *m);
+        return true;
+    }
+    if (word_offsets) word_offsets->assign(seg.words.size(), SIZE_MAX);
+    size_t next_word = 0;
+
+    if (!m_state.empty && m_state.last_char != ' ') {
+        char last_char_of_md = m_state.last_text_char != '\0' ? m_state.last_text_char : '*';
+        char first_char_of_new = seg.text[text_start];
+        bool no_space_needed = (std::string(",.!?;:'\"").find(first_char_of_new) != std::string::npos)
+                                || (std::string("([{\"*").find(last_char_of_md) != std::string::npos);
+        if (!no_space_needed) {
+            put(out, ' ');
+        }
+    }
+
+    const char* marker = "";
+    if (seg.is_bold && seg.is_italic) marker = "***";
+    else if (seg.is_italic) marker = "*";
+    else if (seg.is_bold) marker = "**";
+
+    for (const char* m = marker; *m; ++m) put(out, *m);
+    if (text_offset) *text_offset = out.size();
+    for (size_t i = text_start; i < text_len; ++i) {
+        char c = seg.text[i];
+        if (word_offsets) {
+            while (next_word < seg.words.size() && seg.words[next_word].offset <= i) {
+                if (seg.words[next_word].offset == i) (*word_offsets)[next_word] = out.size();
+                ++next_word;
+            }
+        }
+        // Collapse runs of spaces, as the old regex pass over the whole document did.
+        if (c == ' ' && m_state.last_char == ' ') continue;
+        put(out, c);
+    }
+    for (const char* m = marker; *m; ++m) put(out, *m);
+    return true;
+}
@@ -0,0 +1,39 @@
+#ifndef MARKDOWN_BUILDER_H
+#define MARKDOWN_BUILDER_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include "text_segment.h"
+
+// Incremental Markdown writer shared by the saved document and the live preview.
+// It only remembers the few characters the spacing rules look at, so a caller can
+// snapshot the state after any segment and later resume from there.
+class MarkdownBuilder {
+public:
+    struct State {
+        bool empty = true;
+        char last_char = '\0';
+        char last_text_char = '\0'; // last char that is not '*' or '_' ('\0' if none yet)
+    };
+
+    MarkdownBuilder() = default;
+    explicit MarkdownBuilder(const State& state) : m_state(state) {}
+
+    // Appends one segment to out. Returns false if the segment produced no output.
+    // text_offset (optional) receives the offset in out where the segment's text starts.
+    // word_offsets (optional) receives the offset in out of each of seg.words.
+    bool append_segment(const TextSegment& seg, std::string& out, size_t* text_offset = nullptr,
+                        std::vector<size_t>* word_offsets = nullptr);
+
+    const State& state() const { return m_state; }
+    void reset() { m_state = State{}; }
+    void reset(const State& state) { m_state = state; }
+
+private:
+    void put(std::string& out, char c);
+
+    State m_state;
+};
+
+#endif // MARKDOWN_BUILDER_H
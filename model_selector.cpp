@@ -0,0 +1,322 @@
+#include "model_selector.h"
+#include "whisper_model.h"
+#include "whisper_processor.h"
+#include "wav_io.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <cctype>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+#if defined(__APPLE__)
+#include <sys/sysctl.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const char* PROFILE_HEADER = "# voxformat calibration profile v1";
+
+int size_rank_of(const std::string& family) {
+    static const char* sizes[] = {"tiny", "base", "small", "medium", "large"};
+    for (int i = 0; i < 5; ++i) {
+        if (family.rfind(sizes[i], 0) == 0) return i;
+    }
+    return -1;
+}
+
+int quant_rank_of(const std::string& quant) {
+    static const char* quants[] = {"q2_k", "q3_k", "q4_0", "q4_1", "q4_k", "q5_0", "q5_1", "q5_k", "q6_k", "q8_0", "f16", "f32"};
+    for (int i = 0; i < 12; ++i) {
+        if (quant == quants[i]) return i;
+    }
+    return -1;
+}
+
+std::string cpu_model_name() {
+#if defined(__APPLE__)
+    char brand[256] = {0};
+    size_t len = sizeof(brand);
+    if (sysctlbyname("machdep.cpu.brand_string", brand, &len, nullptr, 0) == 0) return brand;
+#elif defined(__linux__)
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        if (line.rfind("model name", 0) == 0) {
+            size_t colon = line.find(':');
+            if (colon != std::string::npos) return line.substr(colon + 2);
+        }
+    }
+#endif
+    return "unknown-cpu";
+}
+
+std::string host_name() {
+#if defined(_WIN32)
+    if (const char* name = std::getenv("COMPUTERNAME")) return name;
+#else
+    char name[256] = {0};
+    if (gethostname(name, sizeof(name) - 1) == 0 && name[0]) return name;
+#endif
+    return "unknown-host";
+}
+
+std::vector<float> synthetic_speech_like_audio(double seconds) {
+    // Voiced harmonics gated at a syllable-like rate, plus a little noise.
+    size_t n = static_cast<size_t>(seconds * WP_WHISPER_SAMPLE_RATE);
+    std::vector<float> audio(n);
+    std::mt19937 rng(1234);
+    std::normal_distribution<float> noise(0.0f, 0.01f);
+    const double two_pi = 6.283185307179586;
+    for (size_t i = 0; i < n; ++i) {
+        double t = static_cast<double>(i) / WP_WHISPER_SAMPLE_RATE;
+        double pitch = 120.0 + 30.0 * std::sin(two_pi * 0.3 * t);
+        double envelope = std::max(0.0, std::sin(two_pi * 4.0 * t));
+        double voiced = 0.0;
+        for (int h = 1; h <= 6; ++h) voiced += std::sin(two_pi * pitch * h * t) / h;
+        audio[i] = static_cast<float>(0.2 * envelope * voiced) + noise(rng);
+    }
+    return audio;
+}
+
+} // namespace
+
+bool ModelCandidate::more_accurate_than(const ModelCandidate& other) const {
+    if (size_rank != other.size_rank) return size_rank > other.size_rank;
+    return quant_rank > other.quant_rank;
+}
+
+bool parse_model_candidate(const std::string& path, ModelCandidate& out) {
+    // File names follow whisper.cpp's download script: ggml-<size>[.en][-<quant>].bin
+    std::string file = fs::path(path).filename().string();
+    if (file.rfind("ggml-", 0) != 0 || fs::path(file).extension() != ".bin") return false;
+    std::string name = file.substr(5, file.size() - 5 - 4);
+
+    std::string family = name;
+    std::string quant = "f16"; // unquantized downloads are f16
+    size_t dash = name.rfind('-');
+    if (dash != std::string::npos && quant_rank_of(name.substr(dash + 1)) >= 0) {
+        family = name.substr(0, dash);
+        quant = name.substr(dash + 1);
+    }
+    int size_rank = size_rank_of(family);
+    if (size_rank < 0) return false;
+
+    out.path = path;
+    out.name = name;
+    out.size_rank = size_rank;
+    out.quant_rank = quant_rank_of(quant);
+    std::error_code ec;
+    out.file_size = fs::file_size(path, ec);
+    if (ec) out.file_size = 0;
+    return true;
+}
+
+std::vector<ModelCandidate> discover_models(const std::string& models_dir) {
+    std::vector<ModelCandidate> candidates;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(models_dir, ec)) {
+        if (!entry.is_regular_file()) continue;
+        ModelCandidate candidate;
+        if (parse_model_candidate(entry.path().string(), candidate)) candidates.push_back(candidate);
+    }
+    if (ec) {
+        std::cerr << "ModelSelector: Could not list " << models_dir << ": " << ec.message() << std::endl;
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const ModelCandidate& a, const ModelCandidate& b) {
+        return b.more_accurate_than(a);
+    });
+    return candidates;
+}
+
+std::string current_host_key() {
+    return host_name() + "|" + cpu_model_name() + "|" + std::to_string(std::thread::hardware_concurrency());
+}
+
+std::string default_profile_path() {
+    fs::path base;
+#if defined(_WIN32)
+    if (const char* local = std::getenv("LOCALAPPDATA")) base = fs::path(local) / "voxformat";
+#else
+    if (const char* xdg = std::getenv("XDG_CACHE_HOME"); xdg && *xdg) base = fs::path(xdg) / "voxformat";
+    else if (const char* home = std::getenv("HOME")) base = fs::path(home) / ".cache" / "voxformat";
+#endif
+    if (base.empty()) base = fs::current_path();
+    // One file per host so a shared home directory does not mix machines.
+    std::string host = host_name();
+    std::replace_if(host.begin(), host.end(), [](char c) { return !std::isalnum(static_cast<unsigned char>(c)) && c != '-'; }, '_');
+    return (base / ("calibration-" + host + ".profile")).string();
+}
+
+bool load_calibration_profile(const std::string& path, CalibrationProfile& profile) {
+    std::ifstream in(path);
+    if (!in) return false;
+    std::string line;
+    if (!std::getline(in, line) || line != PROFILE_HEADER) {
+        std::cerr << "ModelSelector: Ignoring " << path << " (unknown profile format)." << std::endl;
+        return false;
+    }
+    CalibrationProfile loaded;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string key;
+        fields >> key;
+        if (key == "host") {
+            std::getline(fields >> std::ws, loaded.host_key);
+        } else if (key == "threads") {
+            fields >> loaded.threads;
+        } else if (key == "audio") {
+            std::string source;
+            fields >> source;
+            loaded.synthetic_audio = source == "synthetic";
+        } else if (key == "model") {
+            CalibrationEntry entry;
+            fields >> entry.real_time_factor >> entry.file_size;
+            std::getline(fields >> std::ws, entry.model_path);
+            if (fields.fail() && entry.model_path.empty()) continue;
+            loaded.entries.push_back(entry);
+        }
+    }
+    profile = std::move(loaded);
+    return true;
+}
+
+bool save_calibration_profile(const std::string& path, const CalibrationProfile& profile) {
+    fs::path file_path(path);
+    std::error_code ec;
+    if (file_path.has_parent_path()) fs::create_directories(file_path.parent_path(), ec);
+    fs::path tmp_path = file_path;
+    tmp_path += ".tmp";
+    {
+        std::ofstream out(tmp_path);
+        if (!out) {
+            std::cerr << "ModelSelector: Could not write " << tmp_path.string() << std::endl;
+            return false;
+        }
+        out << PROFILE_HEADER << "\n";
+        out << "host " << profile.host_key << "\n";
+        out << "threads " << profile.threads << "\n";
+        out << "audio " << (profile.synthetic_audio ? "synthetic" : "fixtures") << "\n";
+        for (const auto& entry : profile.entries) {
+            out << "model " << entry.real_time_factor << " " << entry.file_size << " " << entry.model_path << "\n";
+        }
+        if (!out) return false;
+    }
+    fs::rename(tmp_path, file_path, ec);
+    if (ec) {
+        std::cerr << "ModelSelector: Could not save profile to " << path << ": " << ec.message() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+std::vector<float> load_calibration_audio(const std::string& fixtures_dir, double max_audio_seconds, bool* synthetic) {
+    std::vector<float> audio;
+    size_t max_samples = static_cast<size_t>(max_audio_seconds * WP_WHISPER_SAMPLE_RATE);
+    std::vector<fs::path> files;
+    std::error_code ec;
+    if (!fixtures_dir.empty()) {
+        for (const auto& entry : fs::recursive_directory_iterator(fixtures_dir, ec)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".wav") files.push_back(entry.path());
+        }
+    }
+    std::sort(files.begin(), files.end());
+    for (const auto& file : files) {
+        if (audio.size() >= max_samples) break;
+        std::vector<float> samples;
+        int sample_rate = 0;
+        if (!read_wav_file(file.string(), samples, sample_rate)) continue;
+        std::vector<float> resampled = WhisperProcessor::resample_audio(samples, sample_rate);
+        audio.insert(audio.end(), resampled.begin(), resampled.end());
+    }
+    bool use_synthetic = audio.empty();
+    if (use_synthetic) {
+        std::cerr << "ModelSelector: No WAV fixtures found in '" << fixtures_dir
+                  << "'; using synthetic audio, which may understate decoding cost." << std::endl;
+        audio = synthetic_speech_like_audio(max_audio_seconds);
+    }
+    if (synthetic) *synthetic = use_synthetic;
+    if (audio.size() > max_samples) audio.resize(max_samples);
+    return audio;
+}
+
+CalibrationProfile run_calibration(const std::vector<ModelCandidate>& candidates,
+                                   const std::vector<float>& fixture_audio_16k,
+                                   double max_audio_seconds) {
+    CalibrationProfile profile;
+    profile.host_key = current_host_key();
+    whisper_full_params params = WhisperModel::default_decode_params();
+    profile.threads = params.n_threads;
+
+    size_t total_samples = std::min(fixture_audio_16k.size(), static_cast<size_t>(max_audio_seconds * WP_WHISPER_SAMPLE_RATE));
+    size_t window_samples = static_cast<size_t>(WP_PROCESSING_WINDOW_SECONDS_VAL * WP_WHISPER_SAMPLE_RATE);
+    double audio_seconds = static_cast<double>(total_samples) / WP_WHISPER_SAMPLE_RATE;
+    if (total_samples == 0) return profile;
+
+    for (const auto& candidate : candidates) {
+        std::cout << "Calibrating " << candidate.name << " ... " << std::flush;
+        std::shared_ptr<WhisperModel> model = WhisperModel::load(candidate.path, true);
+        if (!model) continue;
+        whisper_state* state = model->create_state();
+        if (!state) continue;
+
+        // Decode in the same window size the live pipeline uses; model loading is excluded.
+        auto start = std::chrono::steady_clock::now();
+        bool ok = true;
+        for (size_t offset = 0; offset < total_samples && ok; offset += window_samples) {
+            size_t n = std::min(window_samples, total_samples - offset);
+            ok = whisper_full_with_state(model->context(), state, params, fixture_audio_16k.data() + offset, static_cast<int>(n)) == 0;
+        }
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        whisper_free_state(state);
+        if (!ok) {
+            std::cout << "decode failed, skipped." << std::endl;
+            continue;
+        }
+
+        CalibrationEntry entry;
+        entry.model_path = fs::absolute(candidate.path).string();
+        entry.file_size = candidate.file_size;
+        entry.real_time_factor = elapsed / audio_seconds;
+        profile.entries.push_back(entry);
+        std::cout << "RTF " << entry.real_time_factor << std::endl;
+    }
+    return profile;
+}
+
+std::string select_model_from_profile(const CalibrationProfile& profile, double target_rtf) {
+    const CalibrationEntry* best = nullptr;
+    ModelCandidate best_candidate;
+    const CalibrationEntry* fastest = nullptr;
+    for (const auto& entry : profile.entries) {
+        ModelCandidate candidate;
+        if (!parse_model_candidate(entry.model_path, candidate)) continue;
+        std::error_code ec;
+        if (!fs::exists(entry.model_path, ec) || candidate.file_size != entry.file_size) continue;
+
+        if (!fastest || entry.real_time_factor < fastest->real_time_factor) fastest = &entry;
+        if (entry.real_time_factor <= target_rtf && (!best || candidate.more_accurate_than(best_candidate))) {
+            best = &entry;
+            best_candidate = candidate;
+        }
+    }
+    if (best) return best->model_path;
+    if (fastest) {
+        std::cerr << "ModelSelector: No calibrated model meets RTF " << target_rtf
+                  << "; using the fastest one (RTF " << fastest->real_time_factor << ")." << std::endl;
+        return fastest->model_path;
+    }
+    return "";
+}
@@ -0,0 +1,58 @@
+#ifndef MODEL_SELECTOR_H
+#define MODEL_SELECTOR_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#define MS_DEFAULT_TARGET_RTF 0.5          // leaves headroom inside each processing window
+#define MS_DEFAULT_CALIBRATION_SECONDS 30.0 // audio decoded per model while calibrating
+#define MS_DEFAULT_MODEL_FILE "ggml-small.en.bin"
+
+// A ggml model file found on disk, ranked by expected accuracy.
+struct ModelCandidate {
+    std::string path;
+    std::string name;      // e.g. "small.en-q5_0"
+    int size_rank = -1;    // tiny < base < small < medium < large
+    int quant_rank = -1;   // q4_0 < ... < q8_0 < f16 < f32
+    uintmax_t file_size = 0;
+
+    bool more_accurate_than(const ModelCandidate& other) const;
+};
+
+struct CalibrationEntry {
+    std::string model_path;
+    uintmax_t file_size = 0;    // detects a model replaced after calibration
+    double real_time_factor = 0; // decode wall time / audio time
+};
+
+// Per-host benchmark results, stored so startup can pick a model without re-measuring.
+struct CalibrationProfile {
+    std::string host_key;
+    int threads = 0;             // decode threads the RTFs were measured with
+    bool synthetic_audio = false; // no fixtures: RTFs come from generated audio
+    std::vector<CalibrationEntry> entries;
+};
+
+std::vector<ModelCandidate> discover_models(const std::string& models_dir);
+bool parse_model_candidate(const std::string& path, ModelCandidate& out);
+
+std::string current_host_key();
+std::string default_profile_path();
+bool load_calibration_profile(const std::string& path, CalibrationProfile& profile);
+bool save_calibration_profile(const std::string& path, const CalibrationProfile& profile);
+
+// Decodes up to max_audio_seconds of fixture audio (16 kHz mono) with every candidate.
+CalibrationProfile run_calibration(const std::vector<ModelCandidate>& candidates,
+                                   const std::vector<float>& fixture_audio_16k,
+                                   double max_audio_seconds = MS_DEFAULT_CALIBRATION_SECONDS);
+// Loads every *.wav under fixtures_dir and resamples it to 16 kHz. Falls back to synthetic
+// audio (with a warning, and *synthetic set) when there are no fixtures.
+std::vector<float> load_calibration_audio(const std::string& fixtures_dir, double max_audio_seconds,
+                                          bool* synthetic = nullptr);
+
+// Picks the most accurate calibrated model that still exists unchanged and meets target_rtf.
+// If none meets it, returns the fastest one. Empty string if the profile has no usable entry.
+std::string select_model_from_profile(const CalibrationProfile& profile, double target_rtf);
+
+#endif // MODEL_SELECTOR_H
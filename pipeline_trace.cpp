@@ -0,0 +1,203 @@
+#include "pipeline_trace.h"
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+enum class TracePhase : char { Complete = 'X', AsyncBegin = 'b', AsyncEnd = 'e' };
+
+struct TraceEvent {
+    const char* name;
+    const char* category;
+    uint64_t ts_us;
+    uint64_t dur_us;
+    uint64_t id;       // async id, or the chunk the span belongs to (0 = none)
+    TracePhase phase;
+};
+
+} // namespace
+
+// Written only by its owning thread. The count is published with release ordering after the
+// event is filled in, so a reader that loads it with acquire sees complete events.
+struct ThreadTraceBuffer {
+    std::unique_ptr<TraceEvent[]> events;
+    std::atomic<size_t> count{0};
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<bool> adopted{false}; // owned by a thread (reserved buffers start unowned)
+    uint32_t tid = 0;
+    std::string thread_name;
+};
+
+namespace {
+
+// Buffers are owned by the registry so they outlive their threads and can still be written out.
+std::mutex g_registry_mutex;
+std::vector<std::unique_ptr<ThreadTraceBuffer>> g_registry;
+
+thread_local ThreadTraceBuffer* t_buffer = nullptr;
+thread_local uint64_t t_current_chunk = 0;
+thread_local uint64_t t_capture_time_us = 0;
+
+const std::chrono::steady_clock::time_point g_epoch = std::chrono::steady_clock::now();
+
+ThreadTraceBuffer* register_buffer(const char* thread_name) {
+    auto buffer = std::make_unique<ThreadTraceBuffer>();
+    buffer->events.reset(new TraceEvent[TRACE_EVENTS_PER_THREAD]);
+    std::lock_guard<std::mutex> lock(g_registry_mutex);
+    buffer->tid = static_cast<uint32_t>(g_registry.size() + 1);
+    if (thread_name) buffer->thread_name = thread_name;
+    g_registry.push_back(std::move(buffer));
+    return g_registry.back().get();
+}
+
+ThreadTraceBuffer* thread_buffer() {
+    if (t_buffer) return t_buffer;
+    // First event on this thread: one allocation, then recording is lock-free.
+    t_buffer = register_buffer(nullptr);
+    t_buffer->adopted.store(true, std::memory_order_relaxed);
+    return t_buffer;
+}
+
+void record(const TraceEvent& event) {
+    ThreadTraceBuffer* buffer = thread_buffer();
+    size_t n = buffer->count.load(std::memory_order_relaxed);
+    if (n >= TRACE_EVENTS_PER_THREAD) {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    buffer->events[n] = event;
+    buffer->count.store(n + 1, std::memory_order_release);
+}
+
+void write_json_string(std::ostream& out, const std::string& s) {
+    out << '"';
+    for (char c : s) {
+        if (c == '"' || c == '\\') out << '\\' << c;
+        else if (static_cast<unsigned char>(c) < 0x20) out << ' ';
+        else out << c;
+    }
+    out << '"';
+}
+
+} // namespace
+
+std::atomic<bool> PipelineTrace::s_enabled{false};
+std::atomic<uint64_t> PipelineTrace::s_next_stream_id{1};
+
+void PipelineTrace::enable() { s_enabled.store(true, std::memory_order_relaxed); }
+
+uint64_t PipelineTrace::now_us() {
+    // +1 keeps 0 free to mean "not recorded".
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - g_epoch).count()) + 1;
+}
+
+void PipelineTrace::span(const char* name, const char* category, uint64_t start_us, uint64_t end_us) {
+    if (!enabled()) return;
+    record({name, category, start_us, end_us > start_us ? end_us - start_us : 0, t_current_chunk, TracePhase::Complete});
+}
+
+void PipelineTrace::async_begin(const char* name, uint64_t id, uint64_t ts_us) {
+    if (!enabled()) return;
+    record({name, "latency", ts_us, 0, id, TracePhase::AsyncBegin});
+}
+
+void PipelineTrace::async_end(const char* name, uint64_t id, uint64_t ts_us) {
+    if (!enabled()) return;
+    record({name, "latency", ts_us, 0, id, TracePhase::AsyncEnd});
+}
+
+void PipelineTrace::set_thread_name(const char* name) {
+    if (!enabled()) return;
+    ThreadTraceBuffer* buffer = thread_buffer();
+    if (buffer->thread_name == name) return; // only the owning thread writes it
+    std::lock_guard<std::mutex> lock(g_registry_mutex);
+    buffer->thread_name = name;
+}
+
+ThreadTraceBuffer* PipelineTrace::reserve_thread_buffer(const char* thread_name) {
+    if (!enabled()) return nullptr;
+    return register_buffer(thread_name);
+}
+
+void PipelineTrace::adopt_thread_buffer(ThreadTraceBuffer* buffer) {
+    if (t_buffer || !buffer) return;
+    bool expected = false;
+    if (buffer->adopted.compare_exchange_strong(expected, true, std::memory_order_relaxed)) t_buffer = buffer;
+}
+
+uint64_t PipelineTrace::new_stream_id() { return s_next_stream_id.fetch_add(1, std::memory_order_relaxed); }
+
+uint64_t PipelineTrace::current_chunk() { return t_current_chunk; }
+void PipelineTrace::set_current_chunk(uint64_t chunk_id) { t_current_chunk = chunk_id; }
+uint64_t PipelineTrace::capture_time_us() { return t_capture_time_us; }
+void PipelineTrace::set_capture_time_us(uint64_t ts_us) { t_capture_time_us = ts_us; }
+
+bool PipelineTrace::write_chrome_trace(const std::string& path) {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out.is_open()) {
+        std::cerr << "Error: Could not open trace file " << path << std::endl;
+        return false;
+    }
+    uint64_t dropped_total = 0;
+    bool first = true;
+    auto separator = [&]() { out << (first ? "\n" : ",\n"); first = false; };
+
+    // Only the buffer list and names need the lock: buffers are never freed, and events below
+    // a published count never change, so they are read after it is released.
+    struct BufferSnapshot {
+        const TraceEvent* events;
+        size_t count;
+        uint32_t tid;
+        std::string thread_name;
+    };
+    std::vector<BufferSnapshot> buffers;
+    {
+        std::lock_guard<std::mutex> lock(g_registry_mutex);
+        buffers.reserve(g_registry.size());
+        for (const auto& buffer : g_registry) {
+            buffers.push_back({buffer->events.get(), buffer->count.load(std::memory_order_acquire), buffer->tid, buffer->thread_name});
+            dropped_total += buffer->dropped.load(std::memory_order_relaxed);
+        }
+    }
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    for (const BufferSnapshot& buffer : buffers) {
+        if (!buffer.thread_name.empty()) {
+            separator();
+            out << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << buffer.tid << ",\"args\":{\"name\":";
+            write_json_string(out, buffer.thread_name);
+            out << "}}";
+        }
+        for (size_t i = 0; i < buffer.count; ++i) {
+            const TraceEvent& e = buffer.events[i];
+            separator();
+            out << "{\"ph\":\"" << static_cast<char>(e.phase) << "\",\"name\":";
+            write_json_string(out, e.name);
+            out << ",\"cat\":";
+            write_json_string(out, e.category);
+            out << ",\"pid\":1,\"tid\":" << buffer.tid << ",\"ts\":" << e.ts_us;
+            if (e.phase == TracePhase::Complete) {
+                out << ",\"dur\":" << e.dur_us;
+                if (e.id != 0) out << ",\"args\":{\"chunk\":" << e.id << "}";
+            } else {
+                out << ",\"id\":" << e.id;
+            }
+            out << "}";
+        }
+    }
+    out << "\n],\"otherData\":{\"dropped_events\":" << dropped_total << "}}\n";
+    out.close();
+    if (out.fail()) {
+        std::cerr << "Error: Failed to write trace file " << path << std::endl;
+        return false;
+    }
+    if (dropped_total > 0) {
+        std::cerr << "Trace: " << dropped_total << " events dropped (per-thread buffer full)." << std::endl;
+    }
+    return true;
+}
@@ -0,0 +1,83 @@
+#ifndef PIPELINE_TRACE_H
+#define PIPELINE_TRACE_H
+
+#include <string>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+#define TRACE_EVENTS_PER_THREAD 262144 // fixed per-thread buffer; later events are dropped
+
+struct ThreadTraceBuffer;
+
+// Opt-in span tracing of the pipeline, exported in Chrome trace-event JSON (chrome://tracing,
+// ui.perfetto.dev). Every thread appends to its own fixed buffer without locks; writing the file
+// only reads what has been published, so it is safe while the pipeline keeps running.
+// With tracing disabled each probe is one relaxed atomic load. Building with
+// VOXFORMAT_ENABLE_TRACING undefined removes the probes entirely.
+class PipelineTrace {
+public:
+    static void enable();
+    static bool enabled() { return s_enabled.load(std::memory_order_relaxed); }
+    // Microseconds on the trace clock (steady clock, zero at first use).
+    static uint64_t now_us();
+
+    // Complete span [start_us, end_us] on the calling thread.
+    static void span(const char* name, const char* category, uint64_t start_us, uint64_t end_us);
+    // Async span on its own track, matched by id (used for latencies that cross threads).
+    static void async_begin(const char* name, uint64_t id, uint64_t ts_us);
+    static void async_end(const char* name, uint64_t id, uint64_t ts_us);
+    static void set_thread_name(const char* name);
+    // A thread's buffer is normally allocated and registered (under a lock) at its first event.
+    // Threads that must not allocate or lock, like the audio callback, get one reserved from
+    // another thread and adopt it on their first call, which does neither. A buffer is adopted
+    // by at most one thread; later adopters fall back to allocating their own.
+    static ThreadTraceBuffer* reserve_thread_buffer(const char* thread_name);
+    static void adopt_thread_buffer(ThreadTraceBuffer* buffer);
+    // Distinct per stream; chunk ids are (stream id << 32) | sequence so they never collide.
+    static uint64_t new_stream_id();
+
+    // Chunk the calling thread is working on; recorded as the "chunk" arg of its spans.
+    static uint64_t current_chunk();
+    static void set_current_chunk(uint64_t chunk_id);
+    // Mic time of the first sample in the buffer the calling (capture) thread is delivering; 0 if unknown.
+    static uint64_t capture_time_us();
+    static void set_capture_time_us(uint64_t ts_us);
+
+    static bool write_chrome_trace(const std::string& path);
+
+private:
+    static std::atomic<bool> s_enabled;
+    static std::atomic<uint64_t> s_next_stream_id;
+};
+
+// Records a span from construction to destruction when tracing is enabled.
+class TraceScope {
+public:
+    TraceScope(const char* name, const char* category)
+        : m_name(name), m_category(category), m_start_us(PipelineTrace::enabled() ? PipelineTrace::now_us() : 0) {}
+    ~TraceScope() {
+        if (m_start_us != 0 && PipelineTrace::enabled()) {
+            PipelineTrace::span(m_name, m_category, m_start_us, PipelineTrace::now_us());
+        }
+    }
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* m_name;
+    const char* m_category;
+    uint64_t m_start_us;
+};
+
+#if defined(VOXFORMAT_ENABLE_TRACING)
+#define VOX_TRACE_CONCAT_INNER(a, b) a##b
+#define VOX_TRACE_CONCAT(a, b) VOX_TRACE_CONCAT_INNER(a, b)
+#define VOX_TRACE_SCOPE(name, category) TraceScope VOX_TRACE_CONCAT(vox_trace_scope_, __LINE__)(name, category)
+#define VOX_TRACE_ACTIVE() PipelineTrace::enabled()
+#else
+#define VOX_TRACE_SCOPE(name, category) do {} while (0)
+#define VOX_TRACE_ACTIVE() false
+#endif
+
+#endif // PIPELINE_TRACE_H
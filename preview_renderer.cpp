@@ -0,0 +1,241 @@
+#include "preview_renderer.h"
+#include "pipeline_trace.h"
+#include <iostream>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#include <sys/ioctl.h>
+#endif
+
+namespace {
+
+bool stdout_is_terminal() {
+#if defined(_WIN32)
+    return _isatty(_fileno(stdout)) != 0;
+#else
+    return isatty(fileno(stdout)) != 0;
+#endif
+}
+
+bool is_utf8_continuation(char c) {
+    return (static_cast<unsigned char>(c) & 0xC0) == 0x80;
+}
+
+} // namespace
+
+PreviewRenderer::PreviewRenderer(const DocumentFormatter& formatter, std::ostream& out, int frames_per_second)
+    : m_formatter(formatter), m_out(out),
+      m_frame_interval(std::chrono::milliseconds(1000 / std::max(1, frames_per_second))),
+      m_use_ansi(&out == &std::cout && stdout_is_terminal()) {}
+
+PreviewRenderer::~PreviewRenderer() {
+    if (m_thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_wake_mutex);
+            m_stop_requested = true;
+        }
+        m_wake_cv.notify_all();
+        m_thread.join();
+    }
+}
+
+void PreviewRenderer::start() {
+    if (m_thread.joinable()) return;
+    m_stop_requested = false;
+    m_thread = std::thread(&PreviewRenderer::render_loop, this);
+}
+
+void PreviewRenderer::stop() {
+    if (m_thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_wake_mutex);
+            m_stop_requested = true;
+        }
+        m_wake_cv.notify_all();
+        m_thread.join();
+    }
+    render_frame();
+    if (m_header_drawn) {
+        m_out << "\n------------------------\n";
+        m_out.flush();
+        m_header_drawn = false;
+    }
+}
+
+void PreviewRenderer::request_frame() {
+    {
+        std::lock_guard<std::mutex> lock(m_wake_mutex);
+        m_frame_requested = true;
+    }
+    m_wake_cv.notify_one();
+}
+
+void PreviewRenderer::render_loop() {
+#if defined(VOXFORMAT_ENABLE_TRACING)
+    PipelineTrace::set_thread_name("preview");
+#endif
+    auto next_frame_time = std::chrono::steady_clock::now();
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_wake_mutex);
+            m_wake_cv.wait(lock, [&]{ return m_frame_requested || m_stop_requested; });
+            if (m_stop_requested) break;
+            // Hold the frame until the interval has elapsed so bursts of updates collapse into one draw.
+            if (m_wake_cv.wait_until(lock, next_frame_time, [&]{ return m_stop_requested; })) break;
+            m_frame_requested = false;
+        }
+        render_frame();
+        next_frame_time = std::chrono::steady_clock::now() + m_frame_interval;
+    }
+}
+
+int PreviewRenderer::query_columns() const {
+    if (m_fixed_columns > 0) return m_fixed_columns;
+#if !defined(_WIN32)
+    if (m_use_ansi) {
+        struct winsize ws {};
+        if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_col > 0) return ws.ws_col;
+    }
+#endif
+    if (const char* env_cols = std::getenv("COLUMNS")) {
+        int cols = std::atoi(env_cols);
+        if (cols > 0) return cols;
+    }
+    return PR_DEFAULT_TERMINAL_COLUMNS;
+}
+
+bool PreviewRenderer::sync_document() {
+    uint64_t revision = m_formatter.get_revision();
+    if (revision == m_seen_revision) return false;
+
+    // Only the last mirrored segment can have been modified in place; everything after it is new.
+    size_t first = m_segments.empty() ? 0 : m_segments.size() - 1;
+    uint64_t generation = 0;
+    size_t total = m_formatter.copy_segments_from(first, m_fetch_scratch, generation);
+    if (generation != m_seen_generation || total < m_segments.size()) {
+        first = 0;
+        total = m_formatter.copy_segments_from(first, m_fetch_scratch, generation);
+    }
+    m_seen_generation = generation;
+    m_seen_revision = revision;
+
+    size_t rebuild_offset = first < m_segment_offsets.size() ? m_segment_offsets[first] : (first == 0 ? 0 : m_text.size());
+    std::string old_tail = m_text.substr(std::min(rebuild_offset, m_text.size()));
+
+    m_text.resize(rebuild_offset);
+    if (first < m_segment_states.size()) m_builder.reset(m_segment_states[first]);
+    else if (first == 0) m_builder.reset();
+    m_segments.resize(first);
+    m_segment_offsets.resize(first);
+    m_segment_states.resize(first);
+
+    for (const auto& seg : m_fetch_scratch) {
+        m_segment_offsets.push_back(m_text.size());
+        m_segment_states.push_back(m_builder.state());
+        m_builder.append_segment(seg, m_text);
+        m_segments.push_back(seg);
+    }
+
+    size_t common = 0;
+    size_t new_tail_len = m_text.size() - rebuild_offset;
+    while (common < old_tail.size() && common < new_tail_len && old_tail[common] == m_text[rebuild_offset + common]) {
+        ++common;
+    }
+    if (common == old_tail.size() && common == new_tail_len) return false; // nothing visible changed
+    m_changed_offset = std::min(m_changed_offset, rebuild_offset + common);
+    return true;
+}
+
+void PreviewRenderer::render_frame() {
+#if defined(VOXFORMAT_ENABLE_TRACING)
+    // Read before syncing so the commit is guaranteed to be part of this frame.
+    uint64_t trace_chunk = 0, trace_commit_us = 0;
+    if (PipelineTrace::enabled()) {
+        m_formatter.get_last_commit_trace(trace_chunk, trace_commit_us);
+        PipelineTrace::set_current_chunk(trace_chunk);
+    }
+#endif
+    VOX_TRACE_SCOPE("preview_frame", "output");
+    if (!sync_document() && m_header_drawn) return;
+    if (m_text.empty() && !m_header_drawn) return;
+    draw_from(m_changed_offset);
+    m_changed_offset = m_text.size();
+    m_frames_rendered.fetch_add(1, std::memory_order_relaxed);
+#if defined(VOXFORMAT_ENABLE_TRACING)
+    if (trace_chunk != 0 && trace_chunk != m_trace_drawn_chunk) {
+        PipelineTrace::async_begin("commit_to_screen", trace_chunk, trace_commit_us);
+        PipelineTrace::async_end("commit_to_screen", trace_chunk, PipelineTrace::now_us());
+        m_trace_drawn_chunk = trace_chunk;
+    }
+#endif
+}
+
+void PreviewRenderer::draw_from(size_t changed_offset) {
+    std::string frame;
+    int columns = query_columns();
+    if (m_header_drawn && columns != m_columns) {
+        // The wrap positions on screen no longer match; start a fresh block rather than guess.
+        frame += "\n";
+        m_header_drawn = false;
+    }
+    m_columns = columns;
+
+    size_t screen_len = m_line_starts.empty() ? 0 : m_screen_len;
+    size_t write_from_line;
+    if (!m_header_drawn) {
+        frame += "\n--- DOCUMENT PREVIEW ---\n";
+        m_line_starts.assign(1, 0);
+        m_header_drawn = true;
+        write_from_line = 0;
+        screen_len = 0;
+    } else {
+        auto it = std::upper_bound(m_line_starts.begin(), m_line_starts.end(), changed_offset);
+        size_t changed_line = static_cast<size_t>(std::distance(m_line_starts.begin(), it)) - 1;
+        size_t cursor_line = m_line_starts.size() - 1;
+        if (changed_offset >= screen_len) {
+            write_from_line = cursor_line; // pure append: keep writing where the cursor is
+        } else if (m_use_ansi) {
+            if (cursor_line > changed_line) frame += "\x1b[" + std::to_string(cursor_line - changed_line) + "A";
+            frame += "\r\x1b[J";
+            write_from_line = changed_line;
+            screen_len = m_line_starts[changed_line];
+        } else {
+            // No cursor control: repeat the changed line below instead of editing it in place.
+            frame += "\n";
+            write_from_line = changed_line;
+            screen_len = m_line_starts[changed_line];
+        }
+    }
+
+    m_line_starts.resize(write_from_line + 1);
+    const size_t wrap_width = static_cast<size_t>(std::max(20, m_columns - 1));
+    size_t line_start = m_line_starts.back();
+    size_t column = 0;
+    for (size_t i = line_start; i < screen_len; ++i) {
+        if (!is_utf8_continuation(m_text[i])) ++column;
+    }
+    for (size_t i = screen_len; i < m_text.size(); ++i) {
+        char c = m_text[i];
+        if (!is_utf8_continuation(c)) {
+            if (column == wrap_width) {
+                frame += m_use_ansi ? "\r\n" : "\n";
+                m_line_starts.push_back(i);
+                column = 0;
+            }
+            ++column;
+        }
+        frame += c;
+    }
+    m_screen_len = m_text.size();
+
+    if (!frame.empty()) {
+        m_out.write(frame.data(), static_cast<std::streamsize>(frame.size()));
+        m_out.flush();
+        m_bytes_written.fetch_add(frame.size(), std::memory_order_relaxed);
+    }
+}
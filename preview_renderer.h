@@ -0,0 +1,80 @@
+#ifndef PREVIEW_RENDERER_H
+#define PREVIEW_RENDERER_H
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <ostream>
+#include <chrono>
+#include <cstdint>
+#include "document_formatter.h"
+#include "markdown_builder.h"
+#include "text_segment.h"
+
+#define PR_DEFAULT_FRAMES_PER_SECOND 10
+#define PR_DEFAULT_TERMINAL_COLUMNS 80
+
+// Live terminal preview of the document, drawn from its own thread.
+// Producers only bump the formatter revision and poke request_frame(); the renderer
+// coalesces those into at most one frame per interval and redraws only the lines that
+// changed since the previous frame (ANSI cursor control on a TTY, append-only otherwise).
+class PreviewRenderer {
+public:
+    PreviewRenderer(const DocumentFormatter& formatter, std::ostream& out, int frames_per_second = PR_DEFAULT_FRAMES_PER_SECOND);
+    ~PreviewRenderer();
+
+    void start();
+    void stop(); // Draws a last frame and closes the preview block.
+    void request_frame();
+
+    // Renders one frame synchronously on the calling thread (used by start()'s thread and benchmarks).
+    void render_frame();
+
+    void set_use_ansi(bool use_ansi) { m_use_ansi = use_ansi; }
+    void set_columns(int columns) { m_fixed_columns = columns; }
+    uint64_t frames_rendered() const { return m_frames_rendered.load(std::memory_order_relaxed); }
+    uint64_t bytes_written() const { return m_bytes_written.load(std::memory_order_relaxed); }
+
+private:
+    void render_loop();
+    bool sync_document();              // Mirrors new/changed segments, returns offset where text changed.
+    void draw_from(size_t changed_offset);
+    int query_columns() const;
+
+    const DocumentFormatter& m_formatter;
+    std::ostream& m_out;
+    std::chrono::milliseconds m_frame_interval;
+    bool m_use_ansi;
+    int m_fixed_columns = 0;
+
+    std::thread m_thread;
+    std::mutex m_wake_mutex;
+    std::condition_variable m_wake_cv;
+    bool m_frame_requested = false;
+    bool m_stop_requested = false;
+
+    // Renderer-thread state: mirror of the document plus the text as it is on screen.
+    std::vector<TextSegment> m_segments;
+    std::vector<size_t> m_segment_offsets;                 // text offset before each segment
+    std::vector<MarkdownBuilder::State> m_segment_states;  // builder state before each segment
+    std::vector<TextSegment> m_fetch_scratch;
+    MarkdownBuilder m_builder;
+    std::string m_text;
+    size_t m_changed_offset = 0;
+    uint64_t m_seen_revision = UINT64_MAX;
+    uint64_t m_seen_generation = 0;
+
+    std::vector<size_t> m_line_starts; // text offset of each terminal line drawn so far
+    size_t m_screen_len = 0;           // how much of m_text is currently on screen
+    int m_columns = 0;
+    bool m_header_drawn = false;
+    uint64_t m_trace_drawn_chunk = 0; // last committed chunk shown (tracing only)
+
+    std::atomic<uint64_t> m_frames_rendered{0};
+    std::atomic<uint64_t> m_bytes_written{0};
+};
+
+#endif // PREVIEW_RENDERER_H
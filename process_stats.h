@@ -0,0 +1,11 @@
+#ifndef PROCESS_STATS_H
+#define PROCESS_STATS_H
+
+#include <cstdint>
+
+// CPU time (user + system) consumed by this process so far, in seconds. 0 if unavailable.
+double process_cpu_seconds();
+// Resident set size of this process in bytes. 0 if unavailable.
+uint64_t process_resident_bytes();
+
+#endif // PROCESS_STATS_H
@@ -0,0 +1,376 @@
+#include "session_recorder.h"
+#include "whisper_processor.h" // WP_WHISPER_SAMPLE_RATE
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+void put_u8(std::string& out, uint8_t v) { out.push_back(static_cast<char>(v)); }
+
+void put_u16(std::string& out, uint16_t v) {
+    out.push_back(static_cast<char>(v & 0xff));
+    out.push_back(static_cast<char>(v >> 8));
+}
+
+void put_u32(std::string& out, uint32_t v) {
+    for (int i = 0; i < 4; ++i) out.push_back(static_cast<char>((v >> (8 * i)) & 0xff));
+}
+
+void put_u64(std::string& out, uint64_t v) {
+    for (int i = 0; i < 8; ++i) out.push_back(static_cast<char>((v >> (8 * i)) & 0xff));
+}
+
+uint32_t get_u32(const unsigned char* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+uint64_t get_u64(const unsigned char* p) {
+    return static_cast<uint64_t>(get_u32(p)) | (static_cast<uint64_t>(get_u32(p + 4)) << 32);
+}
+
+int16_t to_int16(float sample) {
+    float clamped = std::max(-1.0f, std::min(1.0f, sample));
+    return static_cast<int16_t>(std::lround(clamped * 32767.0f));
+}
+
+float from_int16(int16_t sample) { return static_cast<float>(sample) / 32767.0f; }
+
+size_t bytes_per_sample(RecordedSampleFormat format) { return format == RecordedSampleFormat::Int16 ? 2 : 4; }
+
+const size_t CHUNK_PAYLOAD_BYTES = 8 + 4 + 8;
+
+} // namespace
+
+SessionRecorder::SessionRecorder(std::string path, RecordedSampleFormat format)
+    : m_path(std::move(path)), m_format(format) {}
+
+std::shared_ptr<SessionRecorder> SessionRecorder::open(const std::string& path, RecordedSampleFormat format,
+                                                       const std::string& model_path, int decode_threads) {
+    std::shared_ptr<SessionRecorder> recorder(new SessionRecorder(path, format));
+    recorder->m_out.open(path, std::ios::binary | std::ios::trunc);
+    if (!recorder->m_out.is_open()) {
+        std::cerr << "SessionRecorder: Could not create " << path << std::endl;
+        return nullptr;
+    }
+    std::string header(SR_FILE_MAGIC);
+    put_u32(header, WP_WHISPER_SAMPLE_RATE);
+    put_u8(header, static_cast<uint8_t>(format));
+    put_u16(header, static_cast<uint16_t>(std::clamp(decode_threads, 0, 0xffff)));
+    header.push_back('\0');
+    put_u32(header, static_cast<uint32_t>(model_path.size()));
+    header += model_path;
+    recorder->m_out.write(header.data(), static_cast<std::streamsize>(header.size()));
+    recorder->m_bytes_written.store(header.size(), std::memory_order_relaxed);
+    recorder->m_writer = std::thread(&SessionRecorder::writer_loop, recorder.get());
+    return recorder;
+}
+
+SessionRecorder::~SessionRecorder() {
+    {
+        std::lock_guard<std::mutex> lock(m_queue_mutex);
+        m_closing = true;
+    }
+    m_queue_cv.notify_all();
+    if (m_writer.joinable()) m_writer.join();
+}
+
+void SessionRecorder::enqueue(SessionRecord record) {
+    {
+        std::lock_guard<std::mutex> lock(m_queue_mutex);
+        if (m_closing) return;
+        // Document records close the file and are never dropped.
+        if (m_queue.size() >= SR_MAX_QUEUED_RECORDS && record.type != SessionRecordType::Document) {
+            m_dropped_records.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        if (record.type == SessionRecordType::Chunk) m_last_chunk_index = record.chunk_index;
+        if (record.type == SessionRecordType::Format || record.type == SessionRecordType::Audio) record.chunk_index = m_last_chunk_index;
+        m_queue.push_back(std::move(record));
+    }
+    m_queue_cv.notify_one();
+}
+
+uint64_t SessionRecorder::record_audio(const std::vector<float>& samples_16k) {
+    // Positions advance even if the record is dropped, so later windows still line up.
+    const uint64_t first_sample = m_stream_samples;
+    m_stream_samples += samples_16k.size();
+    if (samples_16k.empty()) return first_sample;
+    SessionRecord record;
+    record.type = SessionRecordType::Audio;
+    record.first_sample = first_sample;
+    record.samples = samples_16k;
+    enqueue(std::move(record));
+    return first_sample;
+}
+
+void SessionRecorder::record_chunk(uint64_t chunk_index, uint64_t first_sample, uint64_t sample_count, uint64_t window_start_ms) {
+    SessionRecord record;
+    record.type = SessionRecordType::Chunk;
+    record.chunk_index = chunk_index;
+    record.first_sample = first_sample;
+    record.sample_count = sample_count;
+    record.window_start_ms = window_start_ms;
+    enqueue(std::move(record));
+}
+
+void SessionRecorder::record_transcript(uint64_t chunk_index, const std::string& text, bool committed) {
+    SessionRecord record;
+    record.type = SessionRecordType::Transcript;
+    record.chunk_index = chunk_index;
+    record.text = text;
+    record.committed = committed;
+    enqueue(std::move(record));
+}
+
+void SessionRecorder::record_format_event(FormatEvent event) {
+    SessionRecord record;
+    record.type = SessionRecordType::Format;
+    record.format = event;
+    enqueue(std::move(record));
+}
+
+void SessionRecorder::close(const std::string& final_markdown) {
+    SessionRecord record;
+    record.type = SessionRecordType::Document;
+    record.text = final_markdown;
+    enqueue(std::move(record));
+    {
+        std::lock_guard<std::mutex> lock(m_queue_mutex);
+        m_closing = true;
+    }
+    m_queue_cv.notify_all();
+    if (m_writer.joinable()) m_writer.join();
+    if (m_dropped_records.load(std::memory_order_relaxed) > 0) {
+        std::cerr << "SessionRecorder: " << m_dropped_records.load() << " record(s) dropped because the disk could not keep up; "
+                  << m_path << " will not replay exactly." << std::endl;
+    }
+}
+
+void SessionRecorder::writer_loop() {
+    while (true) {
+        SessionRecord record;
+        {
+            std::unique_lock<std::mutex> lock(m_queue_mutex);
+            m_queue_cv.wait(lock, [&]{ return m_closing || !m_queue.empty(); });
+            if (m_queue.empty()) break; // closing and drained
+            record = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+        write_record(record);
+    }
+    m_out.close();
+}
+
+void SessionRecorder::write_record(const SessionRecord& record) {
+    std::string buffer;
+    put_u8(buffer, static_cast<uint8_t>(record.type));
+    put_u64(buffer, record.chunk_index);
+    switch (record.type) {
+        case SessionRecordType::Chunk:
+            put_u32(buffer, static_cast<uint32_t>(CHUNK_PAYLOAD_BYTES));
+            put_u64(buffer, record.first_sample);
+            put_u32(buffer, static_cast<uint32_t>(record.sample_count));
+            put_u64(buffer, record.window_start_ms);
+            break;
+        case SessionRecordType::Audio: {
+            put_u32(buffer, static_cast<uint32_t>(8 + record.samples.size() * bytes_per_sample(m_format)));
+            put_u64(buffer, record.first_sample);
+            buffer.reserve(buffer.size() + record.samples.size() * bytes_per_sample(m_format));
+            for (float sample : record.samples) {
+                if (m_format == RecordedSampleFormat::Int16) {
+                    uint16_t bits = static_cast<uint16_t>(to_int16(sample));
+                    buffer.push_back(static_cast<char>(bits & 0xff));
+                    buffer.push_back(static_cast<char>(bits >> 8));
+                } else {
+                    uint32_t bits;
+                    std::memcpy(&bits, &sample, sizeof(bits));
+                    put_u32(buffer, bits);
+                }
+            }
+            break;
+        }
+        case SessionRecordType::Transcript:
+            put_u32(buffer, static_cast<uint32_t>(record.text.size() + 1));
+            put_u8(buffer, record.committed ? 1 : 0);
+            buffer += record.text;
+            break;
+        case SessionRecordType::Format:
+            put_u32(buffer, 1);
+            put_u8(buffer, static_cast<uint8_t>(record.format));
+            break;
+        case SessionRecordType::Document:
+            put_u32(buffer, static_cast<uint32_t>(record.text.size()));
+            buffer += record.text;
+            break;
+    }
+    if (buffer.size() - (1 + 8 + 4) > SR_MAX_RECORD_BYTES) {
+        std::cerr << "SessionRecorder: Skipping a " << buffer.size() << " byte record, over the "
+                  << SR_MAX_RECORD_BYTES << " byte limit readers accept." << std::endl;
+        m_dropped_records.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    m_out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    // Keep what is on disk replayable if the process dies mid-session.
+    if (record.type == SessionRecordType::Chunk) m_out.flush();
+    m_bytes_written.fetch_add(buffer.size(), std::memory_order_relaxed);
+}
+
+bool SessionRecordingReader::open(const std::string& path) {
+    m_in.open(path, std::ios::binary | std::ios::ate);
+    if (!m_in.is_open()) {
+        std::cerr << "SessionRecordingReader: Could not open " << path << std::endl;
+        return false;
+    }
+    m_file_size = static_cast<uint64_t>(m_in.tellg());
+    m_in.seekg(0);
+    unsigned char header[8 + 4 + 4 + 4];
+    if (!m_in.read(reinterpret_cast<char*>(header), sizeof(header)) || std::memcmp(header, "VOXREC", 6) != 0) {
+        std::cerr << "SessionRecordingReader: " << path << " is not a voxformat recording." << std::endl;
+        return false;
+    }
+    if (std::memcmp(header, SR_FILE_MAGIC, 8) != 0) {
+        std::cerr << "SessionRecordingReader: " << path << " was written by another version ("
+                  << std::string(reinterpret_cast<const char*>(header), 8) << ", expected " << SR_FILE_MAGIC << ")." << std::endl;
+        return false;
+    }
+    m_sample_rate = static_cast<int>(get_u32(header + 8));
+    uint8_t format = header[12];
+    if (format != static_cast<uint8_t>(RecordedSampleFormat::Int16) &&
+        format != static_cast<uint8_t>(RecordedSampleFormat::Float32)) {
+        std::cerr << "SessionRecordingReader: Unsupported sample format " << static_cast<int>(format) << " in " << path << std::endl;
+        return false;
+    }
+    m_format = static_cast<RecordedSampleFormat>(format);
+    m_decode_threads = header[13] | (header[14] << 8);
+    uint32_t model_path_length = get_u32(header + 16);
+    if (model_path_length > SR_MAX_MODEL_PATH_BYTES || model_path_length > m_file_size - sizeof(header)) {
+        std::cerr << "SessionRecordingReader: Corrupt header in " << path << std::endl;
+        return false;
+    }
+    m_model_path.resize(model_path_length);
+    if (!m_in.read(m_model_path.data(), static_cast<std::streamsize>(m_model_path.size()))) {
+        std::cerr << "SessionRecordingReader: Truncated header in " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool SessionRecordingReader::next(SessionRecord& record) {
+    while (read_record(record)) {
+        if (record.type == SessionRecordType::Audio) {
+            append_audio(record.first_sample, record.samples);
+            continue;
+        }
+        if (record.type == SessionRecordType::Chunk) cut_window(record);
+        return true;
+    }
+    return false;
+}
+
+bool SessionRecordingReader::read_record(SessionRecord& record) {
+    unsigned char head[1 + 8 + 4];
+    if (!m_in.read(reinterpret_cast<char*>(head), sizeof(head))) return false;
+    // The length decides an allocation, so check it before trusting it. A record cut short
+    // by a crash is the normal end of an unfinished recording and is not reported.
+    uint32_t payload_length = get_u32(head + 9);
+    if (payload_length > SR_MAX_RECORD_BYTES) {
+        std::cerr << "SessionRecordingReader: Record of " << payload_length << " bytes is over the "
+                  << SR_MAX_RECORD_BYTES << " byte limit; the recording is corrupt from here on." << std::endl;
+        return false;
+    }
+    if (payload_length > m_file_size - static_cast<uint64_t>(m_in.tellg())) return false;
+    m_payload.resize(payload_length);
+    if (!m_in.read(m_payload.data(), static_cast<std::streamsize>(m_payload.size()))) return false;
+    const unsigned char* payload = reinterpret_cast<const unsigned char*>(m_payload.data());
+
+    record = SessionRecord{};
+    record.type = static_cast<SessionRecordType>(head[0]);
+    record.chunk_index = get_u64(head + 1);
+    switch (record.type) {
+        case SessionRecordType::Chunk:
+            if (m_payload.size() < CHUNK_PAYLOAD_BYTES) return false;
+            record.first_sample = get_u64(payload);
+            record.sample_count = get_u32(payload + 8);
+            record.window_start_ms = get_u64(payload + 12);
+            return true;
+        case SessionRecordType::Audio: {
+            if (m_payload.size() < 8) return false;
+            record.first_sample = get_u64(payload);
+            payload += 8;
+            size_t count = (m_payload.size() - 8) / bytes_per_sample(m_format);
+            record.samples.resize(count);
+            for (size_t i = 0; i < count; ++i) {
+                if (m_format == RecordedSampleFormat::Int16) {
+                    uint16_t bits = static_cast<uint16_t>(payload[2 * i] | (payload[2 * i + 1] << 8));
+                    record.samples[i] = from_int16(static_cast<int16_t>(bits));
+                } else {
+                    uint32_t bits = get_u32(payload + 4 * i);
+                    std::memcpy(&record.samples[i], &bits, sizeof(bits));
+                }
+            }
+            return true;
+        }
+        case SessionRecordType::Transcript:
+            if (m_payload.empty()) return false;
+            record.committed = payload[0] != 0;
+            record.text.assign(m_payload, 1, std::string::npos);
+            return true;
+        case SessionRecordType::Format:
+            if (m_payload.empty()) return false;
+            record.format = static_cast<FormatEvent>(payload[0]);
+            return true;
+        case SessionRecordType::Document:
+            record.text = m_payload;
+            return true;
+    }
+    std::cerr << "SessionRecordingReader: Unknown record type " << static_cast<int>(head[0]) << std::endl;
+    return false;
+}
+
+void SessionRecordingReader::append_audio(uint64_t first_sample, const std::vector<float>& samples) {
+    uint64_t stream_end = m_stream_start + m_stream.size();
+    if (m_stream.empty()) {
+        m_stream_start = first_sample;
+        stream_end = first_sample;
+    }
+    // A gap is audio whose record was dropped; the window that needs it is zero-filled later.
+    if (first_sample > stream_end) {
+        m_stream.clear();
+        m_stream_start = first_sample;
+    }
+    size_t skip = first_sample < m_stream_start + m_stream.size()
+                      ? static_cast<size_t>(std::min<uint64_t>(samples.size(), m_stream_start + m_stream.size() - first_sample))
+                      : 0;
+    m_stream.insert(m_stream.end(), samples.begin() + static_cast<std::ptrdiff_t>(skip), samples.end());
+
+    // Audio no window asks for (skipped while idle) only has to be held until the next window.
+    const size_t max_samples = static_cast<size_t>(SR_REPLAY_STREAM_SECONDS_VAL * m_sample_rate);
+    if (m_stream.size() > max_samples) {
+        size_t excess = m_stream.size() - max_samples;
+        m_stream.erase(m_stream.begin(), m_stream.begin() + static_cast<std::ptrdiff_t>(excess));
+        m_stream_start += excess;
+    }
+}
+
+void SessionRecordingReader::cut_window(SessionRecord& chunk) {
+    chunk.samples.assign(static_cast<size_t>(chunk.sample_count), 0.0f);
+    uint64_t window_end = chunk.first_sample + chunk.sample_count;
+    uint64_t from = std::max(chunk.first_sample, m_stream_start);
+    uint64_t to = std::min(window_end, m_stream_start + m_stream.size());
+    uint64_t present = to > from ? to - from : 0;
+    if (present > 0) {
+        std::copy(m_stream.begin() + static_cast<std::ptrdiff_t>(from - m_stream_start),
+                  m_stream.begin() + static_cast<std::ptrdiff_t>(to - m_stream_start),
+                  chunk.samples.begin() + static_cast<std::ptrdiff_t>(from - chunk.first_sample));
+    }
+    m_missing_samples += chunk.sample_count - present;
+    // Later windows never start before this one, so nothing ahead of it is needed again.
+    if (chunk.first_sample > m_stream_start) {
+        size_t drop = static_cast<size_t>(std::min<uint64_t>(chunk.first_sample - m_stream_start, m_stream.size()));
+        m_stream.erase(m_stream.begin(), m_stream.begin() + static_cast<std::ptrdiff_t>(drop));
+        m_stream_start += drop;
+    }
+}
@@ -0,0 +1,137 @@
+#ifndef SESSION_RECORDER_H
+#define SESSION_RECORDER_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <fstream>
+#include <memory>
+#include <cstdint>
+#include "document_formatter.h"
+
+// .voxrec layout (all integers little-endian):
+//   header: "VOXREC02", u32 sample rate, u8 sample format, u16 decode threads (0: not recorded),
+//           1 reserved byte, u32 length + model path
+//   record: u8 type, u64 chunk index, u32 payload length, payload
+// The audio is stored once, as one 16 kHz stream; chunk records only mark the window each
+// chunk decoded, and the reader cuts the windows back out of the stream.
+#define SR_FILE_MAGIC "VOXREC02"
+#define SR_MAX_QUEUED_RECORDS 256           // records waiting for the writer before new ones are dropped
+#define SR_MAX_RECORD_BYTES (64u << 20)     // larger payloads are treated as corruption
+#define SR_MAX_MODEL_PATH_BYTES 4096
+#define SR_REPLAY_STREAM_SECONDS_VAL 60.0   // audio the reader keeps ahead of the next window
+
+enum class RecordedSampleFormat : uint8_t {
+    Int16 = 1,   // compact; replay decodes the rounded samples, so transcripts can differ slightly
+    Float32 = 2  // exact decoder input, twice the size; replay is bit-exact
+};
+
+enum class SessionRecordType : uint8_t {
+    Chunk = 1,      // payload: u64 first stream sample, u32 sample count, u64 window start (ms of input)
+    Transcript = 2, // payload: u8 committed, then the decoded (cleaned) text
+    Format = 3,     // payload: u8 FormatEvent
+    Document = 4,   // payload: final Markdown, written when the session ends
+    Audio = 5       // payload: u64 first stream sample, then samples (decoded or skipped while idle)
+};
+
+struct SessionRecord {
+    SessionRecordType type = SessionRecordType::Chunk;
+    uint64_t chunk_index = 0;
+    uint64_t first_sample = 0;    // Chunk, Audio: position in the recorded 16 kHz stream
+    uint64_t sample_count = 0;    // Chunk
+    uint64_t window_start_ms = 0; // Chunk: where the window starts in the session's input
+    std::vector<float> samples;   // Audio; Chunk records come out of the reader with their window
+    std::string text;
+    bool committed = false;
+    FormatEvent format = FormatEvent::BoldOn;
+};
+
+// Streams a session's decoder input and results to disk. Producers only queue records; a
+// background thread encodes and writes them, so recording never blocks the pipeline on I/O.
+// Samples are copied when queued; the caller's audio is never modified.
+class SessionRecorder {
+public:
+    // Returns nullptr if the file cannot be created. decode_threads is the whisper thread count
+    // the session decodes with; replay needs it, as float results depend on it.
+    static std::shared_ptr<SessionRecorder> open(const std::string& path, RecordedSampleFormat format,
+                                                 const std::string& model_path, int decode_threads);
+    ~SessionRecorder();
+
+    SessionRecorder(const SessionRecorder&) = delete;
+    SessionRecorder& operator=(const SessionRecorder&) = delete;
+
+    RecordedSampleFormat sample_format() const { return m_format; }
+    // Appends 16 kHz audio to the recorded stream and returns where it starts. Called for every
+    // sample the session consumes, decoded or not, from one thread.
+    uint64_t record_audio(const std::vector<float>& samples_16k);
+    // Marks [first_sample, first_sample + sample_count) of the stream as the window of chunk_index.
+    void record_chunk(uint64_t chunk_index, uint64_t first_sample, uint64_t sample_count, uint64_t window_start_ms);
+    void record_transcript(uint64_t chunk_index, const std::string& text, bool committed);
+    // Attributed to the most recently recorded chunk.
+    void record_format_event(FormatEvent event);
+    // Appends the final document, writes everything queued and closes the file. Idempotent.
+    void close(const std::string& final_markdown);
+
+    const std::string& path() const { return m_path; }
+    uint64_t dropped_records() const { return m_dropped_records.load(std::memory_order_relaxed); }
+    uint64_t bytes_written() const { return m_bytes_written.load(std::memory_order_relaxed); }
+
+private:
+    SessionRecorder(std::string path, RecordedSampleFormat format);
+    void enqueue(SessionRecord record);
+    void writer_loop();
+    void write_record(const SessionRecord& record);
+
+    std::string m_path;
+    RecordedSampleFormat m_format;
+    std::ofstream m_out; // writer thread only, after open()
+
+    std::mutex m_queue_mutex;
+    std::condition_variable m_queue_cv;
+    std::deque<SessionRecord> m_queue;
+    bool m_closing = false;
+    uint64_t m_last_chunk_index = 0;
+    uint64_t m_stream_samples = 0; // producer thread only
+    std::thread m_writer;
+
+    std::atomic<uint64_t> m_dropped_records{0};
+    std::atomic<uint64_t> m_bytes_written{0};
+};
+
+// Sequential reader for .voxrec files. A record cut short (e.g. by a crash) ends the stream, as
+// does one whose length cannot be right. Audio records are consumed internally: next() returns
+// Chunk records with their window rebuilt from the stream, and never returns Audio records.
+class SessionRecordingReader {
+public:
+    bool open(const std::string& path); // reports problems on std::cerr
+    bool next(SessionRecord& record);
+
+    int sample_rate() const { return m_sample_rate; }
+    RecordedSampleFormat sample_format() const { return m_format; }
+    const std::string& model_path() const { return m_model_path; }
+    int decode_threads() const { return m_decode_threads; } // 0 if not recorded
+    // Window samples that were not in the recording (dropped records) and were replaced by silence.
+    uint64_t missing_samples() const { return m_missing_samples; }
+
+private:
+    bool read_record(SessionRecord& record);
+    void append_audio(uint64_t first_sample, const std::vector<float>& samples);
+    void cut_window(SessionRecord& chunk);
+
+    std::ifstream m_in;
+    uint64_t m_file_size = 0;
+    int m_sample_rate = 0;
+    RecordedSampleFormat m_format = RecordedSampleFormat::Int16;
+    std::string m_model_path;
+    int m_decode_threads = 0;
+    std::string m_payload;
+    std::vector<float> m_stream;     // recorded audio not yet behind the latest window
+    uint64_t m_stream_start = 0;     // stream position of m_stream[0]
+    uint64_t m_missing_samples = 0;
+};
+
+#endif // SESSION_RECORDER_H
@@ -13,26 +13,32 @@ fi
 echo "[SUCCESS] Submodules updated."
 echo
 
-# 2. Download Whisper.cpp model
-echo "[INFO] Navigating to Whisper.cpp directory to download model..."
+# 2. Download Whisper.cpp models
+# VOX_MODELS lists the models to fetch. To let VoxFormat pick per host, download several
+# sizes/quantizations and run "./voxformat --calibrate" once, e.g.
+#   VOX_MODELS="base.en small.en small.en-q5_1 medium.en-q5_0" bash setup.sh
+VOX_MODELS="${VOX_MODELS:-small.en}"
+echo "[INFO] Navigating to Whisper.cpp directory to download models: $VOX_MODELS"
 if [ -d "external/whisper.cpp" ]; then
     cd external/whisper.cpp
-    echo "[INFO] Downloading ggml-small.en model for Whisper.cpp..."
-    # Check if models directory exists, if not, the script might create it or be inside it
-    if [ -f "./models/download-ggml-model.sh" ]; then
-        bash ./models/download-ggml-model.sh base.en
-    elif [ -f "./download-ggml-model.sh" ]; then # If script is in root of whisper.cpp
-        bash ./download-ggml-model.sh base.en
-    else
-        echo "[WARNING] Could not find download-ggml-model.sh in standard locations."
-        echo "          Please download 'ggml-small.en.bin' manually into 'external/whisper.cpp/models/'."
-    fi
+    for MODEL in $VOX_MODELS; do
+        echo "[INFO] Downloading ggml-$MODEL model for Whisper.cpp..."
+        # Check if models directory exists, if not, the script might create it or be inside it
+        if [ -f "./models/download-ggml-model.sh" ]; then
+            bash ./models/download-ggml-model.sh "$MODEL"
+        elif [ -f "./download-ggml-model.sh" ]; then # If script is in root of whisper.cpp
+            bash ./download-ggml-model.sh "$MODEL"
+        else
+            echo "[WARNING] Could not find download-ggml-model.sh in standard locations."
+            echo "          Please download 'ggml-$MODEL.bin' manually into 'external/whisper.cpp/models/'."
+        fi
 
-    if [ -f "./models/ggml-small.en.bin" ]; then
-        echo "[SUCCESS] Whisper model ggml-small.en.bin downloaded."
-    else
-        echo "[ERROR] Failed to download Whisper model. Please check 'external/whisper.cpp/models/'."
-    fi
+        if [ -f "./models/ggml-$MODEL.bin" ]; then
+            echo "[SUCCESS] Whisper model ggml-$MODEL.bin downloaded."
+        else
+            echo "[ERROR] Failed to download Whisper model ggml-$MODEL.bin. Please check 'external/whisper.cpp/models/'."
+        fi
+    done
     cd ../.. # Go back to project root
 else
     echo "[ERROR] external/whisper.cpp directory not found. Submodule update might have failed."
@@ -0,0 +1,59 @@
+#ifndef SPSC_RING_BUFFER_H
+#define SPSC_RING_BUFFER_H
+
+#include <vector>
+#include <atomic>
+#include <cstddef>
+#include <algorithm>
+
+// Lock-free single-producer/single-consumer ring buffer. The producer side never blocks or
+// allocates, so it is safe to fill from an audio callback; when full, excess input is dropped.
+template <typename T>
+class SpscRingBuffer {
+public:
+    explicit SpscRingBuffer(size_t min_capacity) {
+        size_t capacity = 1;
+        while (capacity < min_capacity) capacity <<= 1;
+        m_buffer.resize(capacity);
+        m_mask = capacity - 1;
+    }
+
+    size_t capacity() const { return m_buffer.size(); }
+    size_t size() const {
+        return m_write_pos.load(std::memory_order_acquire) - m_read_pos.load(std::memory_order_acquire);
+    }
+
+    // Producer: copies frames elements taken every `stride` items from src (de-interleaving
+    // one channel when stride is the channel count). Returns how many were stored.
+    size_t write_strided(const T* src, size_t frames, size_t stride) {
+        size_t write_pos = m_write_pos.load(std::memory_order_relaxed);
+        size_t free_space = capacity() - (write_pos - m_read_pos.load(std::memory_order_acquire));
+        size_t n = std::min(frames, free_space);
+        for (size_t i = 0; i < n; ++i) {
+            m_buffer[(write_pos + i) & m_mask] = src[i * stride];
+        }
+        m_write_pos.store(write_pos + n, std::memory_order_release);
+        return n;
+    }
+    size_t write(const T* src, size_t count) { return write_strided(src, count, 1); }
+
+    // Consumer: appends everything currently readable to out. Returns the count moved.
+    size_t drain_into(std::vector<T>& out) {
+        size_t read_pos = m_read_pos.load(std::memory_order_relaxed);
+        size_t available = m_write_pos.load(std::memory_order_acquire) - read_pos;
+        size_t first = std::min(available, capacity() - (read_pos & m_mask));
+        out.insert(out.end(), m_buffer.begin() + static_cast<std::ptrdiff_t>(read_pos & m_mask),
+                   m_buffer.begin() + static_cast<std::ptrdiff_t>((read_pos & m_mask) + first));
+        out.insert(out.end(), m_buffer.begin(), m_buffer.begin() + static_cast<std::ptrdiff_t>(available - first));
+        m_read_pos.store(read_pos + available, std::memory_order_release);
+        return available;
+    }
+
+private:
+    std::vector<T> m_buffer;
+    size_t m_mask = 0;
+    alignas(64) std::atomic<size_t> m_write_pos{0};
+    alignas(64) std::atomic<size_t> m_read_pos{0};
+};
+
+#endif // SPSC_RING_BUFFER_H
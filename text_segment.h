@@ -2,12 +2,29 @@
 #include <string>
 #include <vector>
 #include <ostream>
+#include <cstdint>
+
+// A decoded word and when it was spoken, in ms since the start of the session's audio.
+struct SpokenWord {
+    std::string text;
+    uint32_t start_ms = 0;
+    uint32_t end_ms = 0;
+};
+
+// Audio time of a word inside TextSegment::text.
+struct WordTiming {
+    uint32_t offset = 0; // byte offset of the word in the segment text
+    uint32_t length = 0;
+    uint32_t start_ms = 0;
+    uint32_t end_ms = 0;
+};
 
 struct TextSegment {
     std::string text;
     bool is_bold = false;
     bool is_italic = false;
     // bool is_underlined = false;
+    std::vector<WordTiming> words; // sorted by offset; words without a matched timing are absent
 
     TextSegment(std::string t = "", bool b = false, bool i = false) : text(std::move(t)), is_bold(b), is_italic(i) {}
 };
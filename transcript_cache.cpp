@@ -0,0 +1,391 @@
+#include "transcript_cache.h"
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <iomanip>
+#include <thread>
+#include <chrono>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const char kEntryMagic[4] = {'V', 'T', 'C', '1'};
+const uint64_t kModelSampleBytes = 1 << 20; // hashed from each end of the model file
+// Smallest encodings (empty text): bound the counts in an entry by the bytes left for them.
+const size_t kMinSegmentBytes = 4 + 8 + 8 + 4;
+const size_t kMinTokenBytes = 4 + 8 + 8 + 4;
+
+// MurmurHash3 x64_128 (public domain, Austin Appleby). Streamed so the model file and the
+// audio can be hashed without building one buffer.
+class Murmur3x64_128 {
+public:
+    explicit Murmur3x64_128(uint64_t seed = 0) : m_h1(seed), m_h2(seed) {}
+
+    void update(const void* data, size_t len) {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        m_total += len;
+        while (len > 0) {
+            size_t take = std::min(len, sizeof(m_block) - m_block_len);
+            std::memcpy(m_block + m_block_len, p, take);
+            m_block_len += take;
+            p += take;
+            len -= take;
+            if (m_block_len == sizeof(m_block)) {
+                mix_block(m_block);
+                m_block_len = 0;
+            }
+        }
+    }
+
+    std::string hex_digest() const {
+        uint64_t h1 = m_h1, h2 = m_h2, k1 = 0, k2 = 0;
+        for (size_t i = m_block_len; i-- > 8;) k2 = (k2 << 8) | m_block[i];
+        for (size_t i = std::min<size_t>(m_block_len, 8); i-- > 0;) k1 = (k1 << 8) | m_block[i];
+        if (m_block_len > 8) { k2 *= c2; k2 = rotl(k2, 33); k2 *= c1; h2 ^= k2; }
+        if (m_block_len > 0) { k1 *= c1; k1 = rotl(k1, 31); k1 *= c2; h1 ^= k1; }
+        h1 ^= m_total; h2 ^= m_total;
+        h1 += h2; h2 += h1;
+        h1 = fmix(h1); h2 = fmix(h2);
+        h1 += h2; h2 += h1;
+        std::ostringstream out;
+        out << std::hex << std::setfill('0') << std::setw(16) << h1 << std::setw(16) << h2;
+        return out.str();
+    }
+
+private:
+    static constexpr uint64_t c1 = 0x87c37b91114253d5ULL;
+    static constexpr uint64_t c2 = 0x4cf5ad432745937fULL;
+    static uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+    static uint64_t fmix(uint64_t k) {
+        k ^= k >> 33; k *= 0xff51afd7ed558ccdULL;
+        k ^= k >> 33; k *= 0xc4ceb9fe1a85ec53ULL;
+        k ^= k >> 33;
+        return k;
+    }
+    static uint64_t load_le64(const unsigned char* p) {
+        uint64_t v = 0;
+        for (int i = 7; i >= 0; --i) v = (v << 8) | p[i];
+        return v;
+    }
+    void mix_block(const unsigned char* block) {
+        uint64_t k1 = load_le64(block), k2 = load_le64(block + 8);
+        k1 *= c1; k1 = rotl(k1, 31); k1 *= c2; m_h1 ^= k1;
+        m_h1 = rotl(m_h1, 27); m_h1 += m_h2; m_h1 = m_h1 * 5 + 0x52dce729;
+        k2 *= c2; k2 = rotl(k2, 33); k2 *= c1; m_h2 ^= k2;
+        m_h2 = rotl(m_h2, 31); m_h2 += m_h1; m_h2 = m_h2 * 5 + 0x38495ab5;
+    }
+
+    uint64_t m_h1, m_h2;
+    uint64_t m_total = 0;
+    unsigned char m_block[16] = {};
+    size_t m_block_len = 0;
+};
+
+void put_u32(std::string& out, uint32_t v) {
+    for (int i = 0; i < 4; ++i) out.push_back(static_cast<char>((v >> (8 * i)) & 0xff));
+}
+
+void put_i64(std::string& out, int64_t v) {
+    uint64_t u = static_cast<uint64_t>(v);
+    for (int i = 0; i < 8; ++i) out.push_back(static_cast<char>((u >> (8 * i)) & 0xff));
+}
+
+void put_string(std::string& out, const std::string& s) {
+    put_u32(out, static_cast<uint32_t>(s.size()));
+    out += s;
+}
+
+// Bounds-checked cursor over an entry; any overrun marks the entry as corrupt.
+struct EntryReader {
+    const std::string& data;
+    size_t pos = 0;
+    bool ok = true;
+
+    bool take(size_t n) {
+        if (!ok || data.size() - pos < n) { ok = false; return false; }
+        return true;
+    }
+    uint64_t u(size_t bytes) {
+        if (!take(bytes)) return 0;
+        uint64_t v = 0;
+        for (size_t i = bytes; i-- > 0;) v = (v << 8) | static_cast<unsigned char>(data[pos + i]);
+        pos += bytes;
+        return v;
+    }
+    std::string str() {
+        size_t n = static_cast<size_t>(u(4));
+        if (!take(n)) return {};
+        std::string s = data.substr(pos, n);
+        pos += n;
+        return s;
+    }
+};
+
+std::string encode_entry(const std::vector<TranscribedSegment>& segments) {
+    std::string out(kEntryMagic, sizeof(kEntryMagic));
+    put_u32(out, static_cast<uint32_t>(segments.size()));
+    for (const auto& seg : segments) {
+        put_string(out, seg.text);
+        put_i64(out, seg.t0);
+        put_i64(out, seg.t1);
+        put_u32(out, static_cast<uint32_t>(seg.tokens.size()));
+        for (const auto& tok : seg.tokens) {
+            put_string(out, tok.text);
+            put_i64(out, tok.t0);
+            put_i64(out, tok.t1);
+            uint32_t p_bits;
+            std::memcpy(&p_bits, &tok.p, sizeof(p_bits));
+            put_u32(out, p_bits);
+        }
+    }
+    // Trailing checksum catches torn or corrupted files.
+    Murmur3x64_128 hash;
+    hash.update(out.data(), out.size());
+    out += hash.hex_digest();
+    return out;
+}
+
+bool decode_entry(const std::string& data, std::vector<TranscribedSegment>& segments) {
+    const size_t digest_len = 32;
+    if (data.size() < sizeof(kEntryMagic) + digest_len || std::memcmp(data.data(), kEntryMagic, sizeof(kEntryMagic)) != 0) return false;
+    Murmur3x64_128 hash;
+    hash.update(data.data(), data.size() - digest_len);
+    if (data.compare(data.size() - digest_len, digest_len, hash.hex_digest()) != 0) return false;
+
+    EntryReader in{data, sizeof(kEntryMagic)};
+    const size_t body_end = data.size() - digest_len;
+    size_t segment_count = static_cast<size_t>(in.u(4));
+    if (!in.ok || segment_count > (body_end - in.pos) / kMinSegmentBytes) return false;
+    segments.assign(segment_count, TranscribedSegment{});
+    for (auto& seg : segments) {
+        seg.text = in.str();
+        seg.t0 = static_cast<int64_t>(in.u(8));
+        seg.t1 = static_cast<int64_t>(in.u(8));
+        size_t token_count = static_cast<size_t>(in.u(4));
+        if (!in.ok || in.pos > body_end || token_count > (body_end - in.pos) / kMinTokenBytes) return false;
+        seg.tokens.resize(token_count);
+        for (auto& tok : seg.tokens) {
+            tok.text = in.str();
+            tok.t0 = static_cast<int64_t>(in.u(8));
+            tok.t1 = static_cast<int64_t>(in.u(8));
+            uint32_t p_bits = static_cast<uint32_t>(in.u(4));
+            std::memcpy(&tok.p, &p_bits, sizeof(p_bits));
+        }
+        if (!in.ok) return false;
+    }
+    return in.ok && in.pos == body_end;
+}
+
+// store() writes <key>.tmp.<...> and renames it; one left this long belongs to a dead writer.
+bool remove_stale_temp(const fs::directory_entry& entry) {
+    if (entry.path().filename().string().find(".tmp.") == std::string::npos) return false;
+    std::error_code ec;
+    auto age = fs::file_time_type::clock::now() - entry.last_write_time(ec);
+    if (ec || age < std::chrono::seconds(TC_STALE_TEMP_SECONDS)) return false;
+    return fs::remove(entry.path(), ec);
+}
+
+// Size, the first and the last MiB: cheap for multi-GB models and still changes whenever a
+// model file is replaced by a different one.
+std::string hash_model_file(const std::string& model_path) {
+    Murmur3x64_128 hash;
+    std::error_code ec;
+    uint64_t size = fs::file_size(model_path, ec);
+    if (ec) size = 0;
+    hash.update(&size, sizeof(size));
+    std::ifstream in(model_path, std::ios::binary);
+    std::vector<char> buffer(static_cast<size_t>(std::min(size, kModelSampleBytes)));
+    if (in && !buffer.empty()) {
+        in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        hash.update(buffer.data(), static_cast<size_t>(in.gcount()));
+        if (size > kModelSampleBytes) {
+            in.clear();
+            in.seekg(static_cast<std::streamoff>(size - buffer.size()));
+            in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            hash.update(buffer.data(), static_cast<size_t>(in.gcount()));
+        }
+    }
+    return hash.hex_digest();
+}
+
+} // namespace
+
+std::vector<TranscribedSegment> collect_transcribed_segments(whisper_context* ctx, whisper_state* state, bool with_tokens) {
+    std::vector<TranscribedSegment> segments;
+    int n_segments = whisper_full_n_segments_from_state(state);
+    segments.reserve(static_cast<size_t>(std::max(0, n_segments)));
+    const whisper_token eot = with_tokens ? whisper_token_eot(ctx) : 0;
+    for (int i = 0; i < n_segments; ++i) {
+        TranscribedSegment seg;
+        const char* text_cstr = whisper_full_get_segment_text_from_state(state, i);
+        if (text_cstr) seg.text = text_cstr;
+        seg.t0 = whisper_full_get_segment_t0_from_state(state, i);
+        seg.t1 = whisper_full_get_segment_t1_from_state(state, i);
+        if (with_tokens) {
+            int n_tokens = whisper_full_n_tokens_from_state(state, i);
+            for (int t = 0; t < n_tokens; ++t) {
+                whisper_token_data data = whisper_full_get_token_data_from_state(state, i, t);
+                if (data.id >= eot) continue; // timestamps and other special tokens
+                TranscribedToken tok;
+                const char* tok_text = whisper_full_get_token_text_from_state(ctx, state, i, t);
+                if (tok_text) tok.text = tok_text;
+                tok.t0 = data.t0;
+                tok.t1 = data.t1;
+                tok.p = data.p;
+                seg.tokens.push_back(std::move(tok));
+            }
+        }
+        segments.push_back(std::move(seg));
+    }
+    return segments;
+}
+
+TranscriptCache::TranscriptCache(std::string dir, uint64_t max_bytes)
+    : m_dir(std::move(dir)), m_max_bytes(max_bytes) {}
+
+std::shared_ptr<TranscriptCache> TranscriptCache::open(const std::string& dir, uint64_t max_bytes) {
+    std::error_code ec;
+    fs::create_directories(dir, ec);
+    if (!fs::is_directory(dir, ec)) {
+        std::cerr << "TranscriptCache: Could not create cache directory " << dir << std::endl;
+        return nullptr;
+    }
+    std::shared_ptr<TranscriptCache> cache(new TranscriptCache(dir, max_bytes));
+    uint64_t total = 0;
+    for (auto it = fs::recursive_directory_iterator(dir, ec); !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+        std::error_code entry_ec;
+        if (!it->is_regular_file(entry_ec) || remove_stale_temp(*it)) continue;
+        total += it->file_size(entry_ec);
+    }
+    cache->m_bytes_on_disk.store(total, std::memory_order_relaxed);
+    cache->evict_if_needed();
+    return cache;
+}
+
+std::string TranscriptCache::decoder_fingerprint(const std::string& model_path, const whisper_full_params& params) {
+    std::string model_hash;
+    {
+        std::lock_guard<std::mutex> lock(m_fingerprint_mutex);
+        auto it = m_model_fingerprints.find(model_path);
+        if (it == m_model_fingerprints.end()) it = m_model_fingerprints.emplace(model_path, hash_model_file(model_path)).first;
+        model_hash = it->second;
+    }
+    // Everything that can change the decoded text; thread count and callbacks do not.
+    std::ostringstream out;
+    out << model_hash << "|strategy=" << static_cast<int>(params.strategy)
+        << "|lang=" << (params.language ? params.language : "") << "|translate=" << params.translate
+        << "|no_context=" << params.no_context << "|no_timestamps=" << params.no_timestamps
+        << "|single_segment=" << params.single_segment << "|token_timestamps=" << params.token_timestamps
+        << "|max_len=" << params.max_len << "|split_on_word=" << params.split_on_word
+        << "|max_tokens=" << params.max_tokens << "|suppress_blank=" << params.suppress_blank
+        << "|temperature=" << params.temperature << "|best_of=" << params.greedy.best_of
+        << "|beam_size=" << params.beam_search.beam_size << "|patience=" << params.beam_search.patience;
+    return out.str();
+}
+
+std::string TranscriptCache::key_for(const std::vector<float>& audio_16k, const std::string& decoder_fingerprint) const {
+    Murmur3x64_128 hash;
+    hash.update(decoder_fingerprint.data(), decoder_fingerprint.size());
+    hash.update(audio_16k.data(), audio_16k.size() * sizeof(float));
+    return hash.hex_digest();
+}
+
+std::string TranscriptCache::entry_path(const std::string& key) const {
+    return (fs::path(m_dir) / key.substr(0, 2) / (key + ".vtc")).string();
+}
+
+bool TranscriptCache::lookup(const std::string& key, std::vector<TranscribedSegment>& segments) {
+    std::string path = entry_path(key);
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        m_misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+    if (!decode_entry(data, segments)) {
+        std::error_code ec;
+        fs::remove(path, ec);
+        m_misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    // Refresh the entry's age for LRU eviction.
+    std::error_code ec;
+    fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+    m_hits.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void TranscriptCache::store(const std::string& key, const std::vector<TranscribedSegment>& segments) {
+    std::string data = encode_entry(segments);
+    fs::path final_path = entry_path(key);
+    std::error_code ec;
+    fs::create_directories(final_path.parent_path(), ec);
+    // Unique per thread and call, so concurrent writers never share a temporary file.
+    std::ostringstream temp_name;
+    temp_name << key << ".tmp." << std::hash<std::thread::id>{}(std::this_thread::get_id()) << "."
+              << std::chrono::steady_clock::now().time_since_epoch().count() << "."
+              << m_temp_counter.fetch_add(1, std::memory_order_relaxed);
+    fs::path temp_path = final_path.parent_path() / temp_name.str();
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        out.write(data.data(), static_cast<std::streamsize>(data.size()));
+        if (!out) {
+            out.close();
+            fs::remove(temp_path, ec);
+            return;
+        }
+    }
+    fs::rename(temp_path, final_path, ec);
+    if (ec) {
+        fs::remove(temp_path, ec);
+        return;
+    }
+    m_stores.fetch_add(1, std::memory_order_relaxed);
+    m_bytes_on_disk.fetch_add(data.size(), std::memory_order_relaxed);
+    evict_if_needed();
+}
+
+void TranscriptCache::evict_if_needed() {
+    if (m_max_bytes == 0 || m_bytes_on_disk.load(std::memory_order_relaxed) <= m_max_bytes) return;
+    std::lock_guard<std::mutex> lock(m_evict_mutex);
+
+    // Rescan: other processes may have added or evicted entries since our count.
+    struct Entry { fs::path path; fs::file_time_type mtime; uint64_t size; };
+    std::vector<Entry> entries;
+    uint64_t total = 0;
+    std::error_code ec;
+    for (auto it = fs::recursive_directory_iterator(m_dir, ec); !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+        std::error_code entry_ec;
+        if (!it->is_regular_file(entry_ec) || remove_stale_temp(*it) || it->path().extension() != ".vtc") continue;
+        Entry entry{it->path(), it->last_write_time(entry_ec), it->file_size(entry_ec)};
+        if (entry_ec) continue;
+        total += entry.size;
+        entries.push_back(std::move(entry));
+    }
+    if (total > m_max_bytes) {
+        std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.mtime < b.mtime; });
+        const uint64_t target = static_cast<uint64_t>(static_cast<double>(m_max_bytes) * TC_EVICT_TO_FRACTION);
+        for (const auto& entry : entries) {
+            if (total <= target) break;
+            std::error_code remove_ec;
+            if (fs::remove(entry.path, remove_ec)) m_evictions.fetch_add(1, std::memory_order_relaxed);
+            total -= entry.size; // gone either way, possibly evicted by another process
+        }
+    }
+    m_bytes_on_disk.store(total, std::memory_order_relaxed);
+}
+
+TranscriptCacheStats TranscriptCache::stats() const {
+    TranscriptCacheStats s;
+    s.hits = m_hits.load(std::memory_order_relaxed);
+    s.misses = m_misses.load(std::memory_order_relaxed);
+    s.stores = m_stores.load(std::memory_order_relaxed);
+    s.evictions = m_evictions.load(std::memory_order_relaxed);
+    s.bytes_on_disk = m_bytes_on_disk.load(std::memory_order_relaxed);
+    return s;
+}
@@ -0,0 +1,80 @@
+#ifndef TRANSCRIPT_CACHE_H
+#define TRANSCRIPT_CACHE_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <cstdint>
+#include "whisper.h"
+
+#define TC_DEFAULT_MAX_MEGABYTES 512
+#define TC_EVICT_TO_FRACTION 0.9 // eviction frees down to this share of the bound
+#define TC_STALE_TEMP_SECONDS 600 // temporary files this old were left by a writer that died
+
+// Raw decoder output for one window, before artifact cleanup and formatting.
+struct TranscribedToken {
+    std::string text;
+    int64_t t0 = 0; // 10 ms units, relative to the window
+    int64_t t1 = 0;
+    float p = 0.0f;
+};
+
+struct TranscribedSegment {
+    std::string text;
+    int64_t t0 = 0;
+    int64_t t1 = 0;
+    std::vector<TranscribedToken> tokens;
+};
+
+// Reads the segments (and optionally their tokens) of the last whisper_full on state.
+std::vector<TranscribedSegment> collect_transcribed_segments(whisper_context* ctx, whisper_state* state, bool with_tokens);
+
+struct TranscriptCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t stores = 0;
+    uint64_t evictions = 0;
+    uint64_t bytes_on_disk = 0; // as last accounted by this process
+};
+
+// Persistent cache of decoder output keyed by a hash of (16 kHz audio window, model file,
+// decode parameters), so formatting changes can be re-run over old audio without inference.
+// One file per entry under dir/<2 hex>/; entries are written to a temporary file and renamed
+// into place, so any number of threads and processes can share a directory. The least
+// recently used entries (by mtime, refreshed on hits) are evicted beyond max_bytes.
+class TranscriptCache {
+public:
+    // Returns nullptr if the directory cannot be created.
+    static std::shared_ptr<TranscriptCache> open(const std::string& dir, uint64_t max_bytes);
+
+    // Identifies model + decode parameters; hashing the model file is done once per path.
+    std::string decoder_fingerprint(const std::string& model_path, const whisper_full_params& params);
+    std::string key_for(const std::vector<float>& audio_16k, const std::string& decoder_fingerprint) const;
+
+    bool lookup(const std::string& key, std::vector<TranscribedSegment>& segments);
+    void store(const std::string& key, const std::vector<TranscribedSegment>& segments);
+    TranscriptCacheStats stats() const;
+    const std::string& directory() const { return m_dir; }
+
+private:
+    TranscriptCache(std::string dir, uint64_t max_bytes);
+    std::string entry_path(const std::string& key) const;
+    void evict_if_needed();
+
+    std::string m_dir;
+    uint64_t m_max_bytes;
+    std::mutex m_fingerprint_mutex;
+    std::map<std::string, std::string> m_model_fingerprints;
+    std::mutex m_evict_mutex;
+    std::atomic<uint64_t> m_bytes_on_disk{0};
+    std::atomic<uint64_t> m_hits{0};
+    std::atomic<uint64_t> m_misses{0};
+    std::atomic<uint64_t> m_stores{0};
+    std::atomic<uint64_t> m_evictions{0};
+    std::atomic<uint64_t> m_temp_counter{0};
+};
+
+#endif // TRANSCRIPT_CACHE_H
@@ -0,0 +1,83 @@
+#include "vox_session.h"
+#include <iostream>
+
+VoxSession::VoxSession(std::shared_ptr<WhisperModel> model, VoxSessionConfig config)
+    : m_config(std::move(config)) {
+    m_processor = std::make_unique<WhisperProcessor>(std::move(model), m_formatter, m_config.input_sample_rate);
+    m_processor->set_idle_timeout(m_config.idle_after);
+    m_processor->set_inference_pool(m_config.inference_pool);
+    m_processor->set_session_recorder(m_config.recorder);
+    m_processor->set_transcript_cache(m_config.transcript_cache);
+    m_processor->set_word_timestamps(m_config.word_timestamps);
+    m_processor->set_transcript_callback([this](const std::string& text, bool is_final) {
+        VoxEvent event;
+        event.type = is_final ? VoxEventType::FinalTranscript : VoxEventType::PartialTranscript;
+        event.text = text;
+        deliver(std::move(event));
+    });
+    m_formatter.set_event_listener([this](FormatEvent format) {
+        if (m_config.recorder) m_config.recorder->record_format_event(format);
+        VoxEvent event;
+        event.type = VoxEventType::Format;
+        event.format = format;
+        deliver(std::move(event));
+    });
+}
+
+VoxSession::~VoxSession() {
+    finish();
+}
+
+std::unique_ptr<VoxSession> VoxSession::create(std::shared_ptr<WhisperModel> model, VoxSessionConfig config) {
+    if (!model) {
+        std::cerr << "VoxSession: No model supplied." << std::endl;
+        return nullptr;
+    }
+    if (config.input_sample_rate <= 0) {
+        std::cerr << "VoxSession: Invalid input sample rate " << config.input_sample_rate << std::endl;
+        return nullptr;
+    }
+    std::unique_ptr<VoxSession> session(new VoxSession(std::move(model), std::move(config)));
+    if (!session->m_processor->initialize_whisper()) {
+        return nullptr;
+    }
+    session->m_processor->start_processing_thread();
+    return session;
+}
+
+size_t VoxSession::push_pcm(const float* samples, size_t count) {
+    return m_processor->push_audio(samples, count);
+}
+
+size_t VoxSession::push_pcm_strided(const float* samples, size_t frames, size_t stride) {
+    return m_processor->push_audio_strided(samples, frames, stride);
+}
+
+void VoxSession::finish() {
+    if (!m_processor || m_finished) return;
+    m_finished = true;
+    m_processor->request_stop();
+    m_processor->join_thread();
+    if (m_config.recorder) m_config.recorder->close(m_formatter.get_markdown_document());
+}
+
+void VoxSession::deliver(VoxEvent event) {
+    if (m_config.event_callback) {
+        m_config.event_callback(event);
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_queue_mutex);
+    if (m_config.max_queued_events > 0 && m_event_queue.size() >= m_config.max_queued_events) {
+        m_event_queue.pop_front();
+        m_dropped_events.fetch_add(1, std::memory_order_relaxed);
+    }
+    m_event_queue.push_back(std::move(event));
+}
+
+bool VoxSession::poll_event(VoxEvent& out) {
+    std::lock_guard<std::mutex> lock(m_queue_mutex);
+    if (m_event_queue.empty()) return false;
+    out = std::move(m_event_queue.front());
+    m_event_queue.pop_front();
+    return true;
+}
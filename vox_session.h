@@ -0,0 +1,89 @@
+#ifndef VOX_SESSION_H
+#define VOX_SESSION_H
+
+#include <string>
+#include <deque>
+#include <mutex>
+#include <memory>
+#include <functional>
+#include <atomic>
+#include <cstdint>
+#include <chrono>
+#include "whisper_model.h"
+#include "whisper_processor.h"
+#include "document_formatter.h"
+#include "session_recorder.h"
+
+// Embeddable entry point: one dictation session fed with pushed PCM.
+// Sessions keep no global state; several can share one WhisperModel in the same process.
+
+enum class VoxEventType {
+    PartialTranscript, // decoded text of one window, may be dropped as a duplicate
+    FinalTranscript,   // text committed to the document
+    Format             // a recognised voice command, see VoxEvent::format
+};
+
+struct VoxEvent {
+    VoxEventType type = VoxEventType::PartialTranscript;
+    std::string text;
+    FormatEvent format = FormatEvent::BoldOn;
+};
+
+struct VoxSessionConfig {
+    int input_sample_rate = WP_WHISPER_SAMPLE_RATE;
+    // When set, events are delivered on the session's worker thread. Otherwise they are
+    // queued for poll_event(); the oldest are dropped beyond max_queued_events.
+    std::function<void(const VoxEvent&)> event_callback;
+    size_t max_queued_events = 4096;
+    // Free the decoder and listen with a VAD only after this much silence (0 = never).
+    std::chrono::milliseconds idle_after{0};
+    // Shared decode pool; null decodes on the session's own worker thread.
+    std::shared_ptr<InferencePool> inference_pool;
+    // Records decoder input, transcripts and commands for replay; closed by finish().
+    std::shared_ptr<SessionRecorder> recorder;
+    // Token timestamps for every committed word (TextSegment::words), as the word index needs.
+    // Off by default: timestamp decoding is slower.
+    bool word_timestamps = false;
+    // Persistent cache of decoder output, may be shared between sessions.
+    std::shared_ptr<TranscriptCache> transcript_cache;
+};
+
+class VoxSession {
+public:
+    // Returns nullptr if the model is missing or a decoder state cannot be created.
+    static std::unique_ptr<VoxSession> create(std::shared_ptr<WhisperModel> model, VoxSessionConfig config = {});
+    ~VoxSession();
+
+    VoxSession(const VoxSession&) = delete;
+    VoxSession& operator=(const VoxSession&) = delete;
+
+    // Mono float PCM at config.input_sample_rate. Lock-free, so it can be called from an
+    // audio callback, but only from one thread at a time. Returns the samples accepted.
+    size_t push_pcm(const float* samples, size_t count);
+    // One channel of interleaved PCM: frames samples, stride floats apart.
+    size_t push_pcm_strided(const float* samples, size_t frames, size_t stride);
+    // Processes everything pushed so far and stops the worker. Blocks until done. Later calls
+    // (including the destructor's) do nothing.
+    void finish();
+    bool poll_event(VoxEvent& out);
+    uint64_t dropped_events() const { return m_dropped_events.load(std::memory_order_relaxed); }
+
+    std::string markdown() const { return m_formatter.get_markdown_document(); }
+    DocumentFormatter& formatter() { return m_formatter; }
+    WhisperProcessor& processor() { return *m_processor; }
+
+private:
+    VoxSession(std::shared_ptr<WhisperModel> model, VoxSessionConfig config);
+    void deliver(VoxEvent event);
+
+    VoxSessionConfig m_config;
+    DocumentFormatter m_formatter;
+    std::unique_ptr<WhisperProcessor> m_processor;
+    bool m_finished = false;
+
+    std::mutex m_queue_mutex;
+    std::deque<VoxEvent> m_event_queue;
+    std::atomic<uint64_t> m_dropped_events{0};
+};
+
+#endif // VOX_SESSION_H
@@ -0,0 +1,92 @@
+/* voxformat.h - C API of libvoxformat.
+ *
+ * A vox_model is loaded once and can back any number of vox_sessions, each of which
+ * turns pushed PCM into a formatted document. All functions are reentrant; each session
+ * must be fed by one thread at a time and not freed while that thread is still pushing.
+ *
+ * No C++ exception crosses this API: a failure inside the engine (including running out of
+ * memory) is reported as NULL, -1 or 0 as documented for each function. Event callbacks must
+ * not throw or longjmp out either.
+ *
+ * Define VOXFORMAT_STATIC when linking the static library (the voxformat_static CMake target
+ * does this for you).
+ */
+#ifndef VOXFORMAT_H
+#define VOXFORMAT_H
+
+#include <stddef.h>
+
+#if defined(VOXFORMAT_STATIC)
+#  define VOXFORMAT_API
+#elif defined(_WIN32)
+#  if defined(VOXFORMAT_BUILD_SHARED)
+#    define VOXFORMAT_API __declspec(dllexport)
+#  else
+#    define VOXFORMAT_API __declspec(dllimport)
+#  endif
+#else
+#  define VOXFORMAT_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct vox_model vox_model;
+typedef struct vox_session vox_session;
+
+typedef enum {
+    VOX_EVENT_PARTIAL_TRANSCRIPT = 0,
+    VOX_EVENT_FINAL_TRANSCRIPT = 1,
+    VOX_EVENT_FORMAT = 2
+} vox_event_type;
+
+typedef enum {
+    VOX_FORMAT_BOLD_ON = 0,
+    VOX_FORMAT_BOLD_OFF = 1,
+    VOX_FORMAT_ITALIC_ON = 2,
+    VOX_FORMAT_ITALIC_OFF = 3,
+    VOX_FORMAT_STOP_APPLICATION = 4
+} vox_format_event;
+
+typedef struct {
+    vox_event_type type;
+    const char* text;        /* transcript events only; valid for the duration of the callback / until the next poll */
+    vox_format_event format; /* VOX_EVENT_FORMAT only */
+} vox_event;
+
+typedef void (*vox_event_callback)(const vox_event* event, void* user_data);
+
+typedef struct {
+    int input_sample_rate;       /* Hz, mono float PCM */
+    vox_event_callback callback; /* NULL: queue events for vox_session_poll_event */
+    void* user_data;
+} vox_session_config;
+
+/* Returns NULL if the model cannot be loaded. */
+VOXFORMAT_API vox_model* vox_model_load(const char* model_path, int use_gpu);
+VOXFORMAT_API void vox_model_free(vox_model* model);
+
+VOXFORMAT_API vox_session_config vox_session_default_config(void);
+/* The session keeps its own reference to the model; the model may be freed first.
+ * Returns NULL on failure. */
+VOXFORMAT_API vox_session* vox_session_create(vox_model* model, const vox_session_config* config);
+VOXFORMAT_API void vox_session_free(vox_session* session);
+
+/* Returns 0 on success, -1 on invalid arguments or failure. Never blocks; if the session has
+ * fallen more than 30 s behind, the excess samples are dropped. */
+VOXFORMAT_API int vox_session_push_pcm(vox_session* session, const float* samples, size_t count);
+/* Processes all pushed audio and stops the session's worker. Blocks until done.
+ * Returns 0 on success, -1 on invalid arguments or failure. */
+VOXFORMAT_API int vox_session_finish(vox_session* session);
+/* Returns 1 and fills *event if one was queued, 0 if the queue is empty, -1 on error. */
+VOXFORMAT_API int vox_session_poll_event(vox_session* session, vox_event* event);
+/* Copies the Markdown document (NUL-terminated, truncated to buffer_size) and returns
+ * the buffer size needed to hold all of it; 0 on failure. */
+VOXFORMAT_API size_t vox_session_get_markdown(vox_session* session, char* buffer, size_t buffer_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VOXFORMAT_H */
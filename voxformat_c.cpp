@@ -0,0 +1,149 @@
+#include "voxformat.h"
+#include "vox_session.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <exception>
+
+struct vox_model {
+    std::shared_ptr<WhisperModel> model;
+};
+
+struct vox_session {
+    std::unique_ptr<VoxSession> session;
+    VoxEvent last_polled; // keeps the text of the last polled event alive
+};
+
+namespace {
+
+vox_format_event to_c_format(FormatEvent format) {
+    switch (format) {
+        case FormatEvent::BoldOn: return VOX_FORMAT_BOLD_ON;
+        case FormatEvent::BoldOff: return VOX_FORMAT_BOLD_OFF;
+        case FormatEvent::ItalicOn: return VOX_FORMAT_ITALIC_ON;
+        case FormatEvent::ItalicOff: return VOX_FORMAT_ITALIC_OFF;
+        case FormatEvent::StopApplication: return VOX_FORMAT_STOP_APPLICATION;
+    }
+    return VOX_FORMAT_BOLD_ON;
+}
+
+vox_event to_c_event(const VoxEvent& event) {
+    vox_event out{};
+    switch (event.type) {
+        case VoxEventType::PartialTranscript: out.type = VOX_EVENT_PARTIAL_TRANSCRIPT; break;
+        case VoxEventType::FinalTranscript: out.type = VOX_EVENT_FINAL_TRANSCRIPT; break;
+        case VoxEventType::Format: out.type = VOX_EVENT_FORMAT; break;
+    }
+    out.text = event.type == VoxEventType::Format ? nullptr : event.text.c_str();
+    out.format = to_c_format(event.format);
+    return out;
+}
+
+// Every entry point runs its body through this: no exception may unwind into a C caller.
+template <typename Result, typename Body>
+Result guarded(Result on_failure, Body body) noexcept {
+    try {
+        return body();
+    } catch (const std::exception& e) {
+        std::cerr << "libvoxformat: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "libvoxformat: Unknown error" << std::endl;
+    }
+    return on_failure;
+}
+
+} // namespace
+
+extern "C" {
+
+vox_model* vox_model_load(const char* model_path, int use_gpu) {
+    return guarded<vox_model*>(nullptr, [&]() -> vox_model* {
+        if (!model_path) return nullptr;
+        std::shared_ptr<WhisperModel> model = WhisperModel::load(model_path, use_gpu != 0);
+        if (!model) return nullptr;
+        return new vox_model{std::move(model)};
+    });
+}
+
+void vox_model_free(vox_model* model) {
+    guarded(0, [&]() {
+        delete model;
+        return 0;
+    });
+}
+
+vox_session_config vox_session_default_config(void) {
+    vox_session_config config{};
+    config.input_sample_rate = WP_WHISPER_SAMPLE_RATE;
+    config.callback = nullptr;
+    config.user_data = nullptr;
+    return config;
+}
+
+vox_session* vox_session_create(vox_model* model, const vox_session_config* config) {
+    return guarded<vox_session*>(nullptr, [&]() -> vox_session* {
+        if (!model) return nullptr;
+        vox_session_config c_config = config ? *config : vox_session_default_config();
+
+        VoxSessionConfig session_config;
+        session_config.input_sample_rate = c_config.input_sample_rate;
+        if (c_config.callback) {
+            vox_event_callback callback = c_config.callback;
+            void* user_data = c_config.user_data;
+            session_config.event_callback = [callback, user_data](const VoxEvent& event) {
+                vox_event c_event = to_c_event(event);
+                callback(&c_event, user_data);
+            };
+        }
+        std::unique_ptr<VoxSession> session = VoxSession::create(model->model, std::move(session_config));
+        if (!session) return nullptr;
+        return new vox_session{std::move(session), VoxEvent{}};
+    });
+}
+
+void vox_session_free(vox_session* session) {
+    guarded(0, [&]() {
+        delete session;
+        return 0;
+    });
+}
+
+int vox_session_push_pcm(vox_session* session, const float* samples, size_t count) {
+    if (!session || (!samples && count > 0)) return -1;
+    return guarded(-1, [&]() {
+        session->session->push_pcm(samples, count);
+        return 0;
+    });
+}
+
+int vox_session_finish(vox_session* session) {
+    if (!session) return -1;
+    return guarded(-1, [&]() {
+        session->session->finish();
+        return 0;
+    });
+}
+
+int vox_session_poll_event(vox_session* session, vox_event* event) {
+    if (!session || !event) return -1;
+    return guarded(-1, [&]() {
+        if (!session->session->poll_event(session->last_polled)) return 0;
+        *event = to_c_event(session->last_polled);
+        return 1;
+    });
+}
+
+size_t vox_session_get_markdown(vox_session* session, char* buffer, size_t buffer_size) {
+    if (!session) return 0;
+    return guarded<size_t>(0, [&]() -> size_t {
+        std::string markdown = session->session->markdown();
+        if (buffer && buffer_size > 0) {
+            size_t n = std::min(markdown.size(), buffer_size - 1);
+            std::memcpy(buffer, markdown.data(), n);
+            buffer[n] = '\0';
+        }
+        return markdown.size() + 1;
+    });
+}
+
+} // extern "C"
@@ -0,0 +1,105 @@
+#include "wav_io.h"
+#include <iostream>
+#include <fstream>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+uint16_t read_u16_le(const unsigned char* p) { return static_cast<uint16_t>(p[0] | (p[1] << 8)); }
+uint32_t read_u32_le(const unsigned char* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+const uint16_t WAV_FORMAT_PCM = 1;
+const uint16_t WAV_FORMAT_IEEE_FLOAT = 3;
+const uint16_t WAV_FORMAT_EXTENSIBLE = 0xFFFE;
+
+} // namespace
+
+bool read_wav_file(const std::string& path, std::vector<float>& mono_samples, int& sample_rate) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        std::cerr << "WAV: Could not open " << path << std::endl;
+        return false;
+    }
+    unsigned char riff[12];
+    if (!in.read(reinterpret_cast<char*>(riff), 12) || std::memcmp(riff, "RIFF", 4) != 0 || std::memcmp(riff + 8, "WAVE", 4) != 0) {
+        std::cerr << "WAV: " << path << " is not a RIFF/WAVE file." << std::endl;
+        return false;
+    }
+    // Chunk sizes come from the file; never allocate more than it can still hold.
+    in.seekg(0, std::ios::end);
+    const uint64_t file_size = static_cast<uint64_t>(in.tellg());
+    in.seekg(12, std::ios::beg);
+
+    uint16_t format = 0, channels = 0, bits = 0;
+    uint32_t rate = 0;
+    bool have_fmt = false;
+    unsigned char chunk_header[8];
+    while (in.read(reinterpret_cast<char*>(chunk_header), 8)) {
+        uint32_t chunk_size = read_u32_le(chunk_header + 4);
+        uint64_t remaining = file_size - static_cast<uint64_t>(in.tellg());
+        if (std::memcmp(chunk_header, "fmt ", 4) == 0) {
+            if (chunk_size < 16 || chunk_size > remaining) break;
+            std::vector<unsigned char> fmt(chunk_size);
+            if (!in.read(reinterpret_cast<char*>(fmt.data()), chunk_size)) break;
+            format = read_u16_le(fmt.data());
+            channels = read_u16_le(fmt.data() + 2);
+            rate = read_u32_le(fmt.data() + 4);
+            bits = read_u16_le(fmt.data() + 14);
+            if (format == WAV_FORMAT_EXTENSIBLE && chunk_size >= 26) format = read_u16_le(fmt.data() + 24);
+            have_fmt = true;
+        } else if (std::memcmp(chunk_header, "data", 4) == 0) {
+            if (!have_fmt || channels == 0) break;
+            bool is_float = format == WAV_FORMAT_IEEE_FLOAT && bits == 32;
+            bool is_pcm = format == WAV_FORMAT_PCM && (bits == 16 || bits == 24 || bits == 32);
+            if (!is_float && !is_pcm) {
+                std::cerr << "WAV: Unsupported sample format " << format << "/" << bits << " bits in " << path << std::endl;
+                return false;
+            }
+            if (rate == 0 || rate > static_cast<uint32_t>(std::numeric_limits<int>::max())) {
+                std::cerr << "WAV: Unsupported sample rate " << rate << " in " << path << std::endl;
+                return false;
+            }
+            size_t bytes_per_sample = bits / 8;
+            size_t frame_bytes = bytes_per_sample * channels;
+            // Streaming writers may leave the data size at 0xFFFFFFFF; read what is there.
+            size_t data_bytes = static_cast<size_t>(std::min<uint64_t>(chunk_size, remaining));
+            std::vector<unsigned char> data(data_bytes);
+            in.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data_bytes));
+            size_t frames = static_cast<size_t>(in.gcount()) / frame_bytes;
+
+            mono_samples.assign(frames, 0.0f);
+            for (size_t f = 0; f < frames; ++f) {
+                float sum = 0.0f;
+                for (size_t c = 0; c < channels; ++c) {
+                    const unsigned char* p = data.data() + f * frame_bytes + c * bytes_per_sample;
+                    float v;
+                    if (is_float) {
+                        uint32_t raw = read_u32_le(p);
+                        std::memcpy(&v, &raw, sizeof(v));
+                    } else if (bits == 16) {
+                        v = static_cast<int16_t>(read_u16_le(p)) / 32768.0f;
+                    } else if (bits == 24) {
+                        int32_t s = static_cast<int32_t>((p[0] << 8) | (p[1] << 16) | (p[2] << 24)) >> 8;
+                        v = s / 8388608.0f;
+                    } else {
+                        v = static_cast<int32_t>(read_u32_le(p)) / 2147483648.0f;
+                    }
+                    sum += v;
+                }
+                mono_samples[f] = sum / channels;
+            }
+            sample_rate = static_cast<int>(rate);
+            return true;
+        } else {
+            in.seekg(chunk_size + (chunk_size & 1), std::ios::cur);
+        }
+    }
+    std::cerr << "WAV: No usable fmt/data chunks in " << path << std::endl;
+    return false;
+}
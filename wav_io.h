@@ -0,0 +1,11 @@
+#ifndef WAV_IO_H
+#define WAV_IO_H
+
+#include <string>
+#include <vector>
+
+// Reads a RIFF/WAVE file (16/24/32-bit PCM or 32-bit float) and mixes it down to mono floats.
+// Reports problems on std::cerr and returns false.
+bool read_wav_file(const std::string& path, std::vector<float>& mono_samples, int& sample_rate);
+
+#endif // WAV_IO_H
@@ -0,0 +1,43 @@
+#include "whisper_model.h"
+#include <iostream>
+
+WhisperModel::WhisperModel(std::string model_path, whisper_context* ctx)
+    : m_model_path(std::move(model_path)), m_whisper_ctx(ctx) {}
+
+WhisperModel::~WhisperModel() {
+    if (m_whisper_ctx) { whisper_free(m_whisper_ctx); m_whisper_ctx = nullptr; }
+}
+
+std::shared_ptr<WhisperModel> WhisperModel::load(const std::string& model_path, bool use_gpu) {
+    whisper_context_params cparams = whisper_context_default_params();
+    cparams.use_gpu = use_gpu;
+#if !defined(__APPLE__)
+    cparams.use_gpu = false;
+#endif
+    // No default state: each processor owns one, created through create_state().
+    whisper_context* ctx = whisper_init_from_file_with_params_no_state(model_path.c_str(), cparams);
+    if (!ctx) {
+        std::cerr << "WhisperModel: Failed to load model from " << model_path << std::endl;
+        return nullptr;
+    }
+    return std::shared_ptr<WhisperModel>(new WhisperModel(model_path, ctx));
+}
+
+whisper_state* WhisperModel::create_state() const {
+    whisper_state* state = whisper_init_state(m_whisper_ctx);
+    if (!state) {
+        std::cerr << "WhisperModel: Failed to create decoder state for " << m_model_path << std::endl;
+    }
+    return state;
+}
+
+whisper_full_params WhisperModel::default_decode_params(bool word_timestamps) {
+    whisper_full_params params = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
+    params.language         = "en";
+    params.suppress_blank   = true;
+    params.print_realtime   = false;
+    params.print_progress   = false;
+    params.no_timestamps    = !word_timestamps;
+    params.token_timestamps = word_timestamps;
+    return params;
+}
@@ -0,0 +1,35 @@
+#ifndef WHISPER_MODEL_H
+#define WHISPER_MODEL_H
+
+#include <string>
+#include <memory>
+#include "whisper.h"
+
+// A loaded whisper model. The weights are read once and shared; every session or
+// processor creates its own whisper_state from it, so many can decode concurrently.
+class WhisperModel {
+public:
+    // Returns nullptr (and reports on std::cerr) if the model cannot be loaded.
+    static std::shared_ptr<WhisperModel> load(const std::string& model_path, bool use_gpu);
+    ~WhisperModel();
+
+    WhisperModel(const WhisperModel&) = delete;
+    WhisperModel& operator=(const WhisperModel&) = delete;
+
+    whisper_context* context() const { return m_whisper_ctx; }
+    const std::string& path() const { return m_model_path; }
+    whisper_state* create_state() const;
+
+    // Decoding settings used for live transcription; calibration measures with the same ones.
+    // word_timestamps adds whisper's timestamp mode and token timestamps, which the word index
+    // needs and which cost extra decode time.
+    static whisper_full_params default_decode_params(bool word_timestamps = false);
+
+private:
+    WhisperModel(std::string model_path, whisper_context* ctx);
+
+    std::string m_model_path;
+    whisper_context* m_whisper_ctx;
+};
+
+#endif // WHISPER_MODEL_H
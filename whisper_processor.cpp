@@ -6,53 +6,76 @@
 #include <cmath>
 #include <chrono>
 #include <algorithm>
+#include "process_stats.h"
 
-WhisperProcessor::WhisperProcessor(const std::string& model_path,
-                                   std::vector<float>& shared_audio_buffer,
-                                   std::mutex& buffer_mutex,
-                                   std::condition_variable& buffer_cv,
-                                   std::atomic<bool>& stop_flag,
-                                   DocumentFormatter& formatter)
-    : m_model_path(model_path), m_whisper_ctx(nullptr),
-      m_shared_audio_buffer_ref(shared_audio_buffer),
-      m_buffer_mutex_ref(buffer_mutex),
-      m_buffer_cv_ref(buffer_cv),
-      m_stop_flag_ref(stop_flag),
+namespace {
+
+// Whisper tokens are word pieces; a piece starting with a space begins a new word.
+std::vector<SpokenWord> spoken_words(const std::vector<TranscribedSegment>& segments, uint64_t window_start_ms) {
+    std::vector<SpokenWord> words;
+    for (const TranscribedSegment& segment : segments) {
+        bool segment_start = true;
+        for (const TranscribedToken& token : segment.tokens) {
+            if (token.text.empty()) continue;
+            bool starts_word = segment_start || token.text.front() == ' ' || words.empty();
+            segment_start = false;
+            uint32_t start_ms = static_cast<uint32_t>(window_start_ms + static_cast<uint64_t>(std::max<int64_t>(0, token.t0)) * 10);
+            uint32_t end_ms = static_cast<uint32_t>(window_start_ms + static_cast<uint64_t>(std::max<int64_t>(0, token.t1)) * 10);
+            if (starts_word) {
+                words.push_back({trim_string_util(token.text), start_ms, end_ms});
+            } else {
+                words.back().text += token.text;
+                words.back().end_ms = std::max(words.back().end_ms, end_ms);
+            }
+        }
+    }
+    words.erase(std::remove_if(words.begin(), words.end(), [](const SpokenWord& w) { return w.text.empty(); }), words.end());
+    return words;
+}
+
+} // namespace
+
+WhisperProcessor::WhisperProcessor(std::shared_ptr<WhisperModel> model,
+                                   DocumentFormatter& formatter,
+                                   int input_sample_rate)
+    : m_model(std::move(model)), m_whisper_state(nullptr),
+      m_input_sample_rate(input_sample_rate),
+      m_chunk_processing_samples(static_cast<size_t>(input_sample_rate * WP_PROCESSING_WINDOW_SECONDS_VAL)),
+      m_min_samples_for_final_chunk(static_cast<size_t>(input_sample_rate * WP_MIN_CHUNK_PROCESS_SECONDS_VAL)),
+      m_input_ring(static_cast<size_t>(input_sample_rate * WP_INPUT_RING_SECONDS_VAL)),
+      m_capture_marks(WP_CAPTURE_MARK_CAPACITY),
+      m_drop_marks(WP_DROP_MARK_CAPACITY),
+      m_trace_stream_id(PipelineTrace::new_stream_id()),
       m_formatter_ref(formatter),
-      m_previous_chunk_full_text_for_dedup(""),
-      m_first_transcription_run(true) {
+      m_vad(input_sample_rate),
+      m_first_transcription_run(true),
+      m_previous_chunk_full_text_for_dedup("") {
     m_last_activity_time.store(std::chrono::steady_clock::now());
 }
 
 WhisperProcessor::~WhisperProcessor() {
     if (m_worker_thread.joinable()) {
-        m_stop_flag_ref.store(true);
-        m_buffer_cv_ref.notify_all();
+        request_stop();
         m_worker_thread.join();
     }
-    if (m_whisper_ctx) { whisper_free(m_whisper_ctx); m_whisper_ctx = nullptr; }
+    if (m_whisper_state) { whisper_free_state(m_whisper_state); m_whisper_state = nullptr; }
 }
 
 bool WhisperProcessor::is_thread_joinable() const { return m_worker_thread.joinable(); }
 
 bool WhisperProcessor::initialize_whisper() {
-    whisper_context_params cparams = whisper_context_default_params();
-    cparams.use_gpu = true;
-#if defined(__APPLE__)
-#else
-    cparams.use_gpu = false;
-#endif
-    m_whisper_ctx = whisper_init_from_file_with_params(m_model_path.c_str(), cparams);
-    if (!m_whisper_ctx) {
-        std::cerr << "WhisperProcessor: Failed to load model from " << m_model_path << std::endl;
+    if (m_whisper_state) return true;
+    if (!m_model) {
+        std::cerr << "WhisperProcessor: No model supplied." << std::endl;
         return false;
     }
-    return true;
+    m_whisper_state = m_model->create_state();
+    return m_whisper_state != nullptr;
 }
 
 void WhisperProcessor::start_processing_thread() {
-    if (!m_whisper_ctx) {
-        std::cerr << "WhisperProcessor: Whisper context not initialized. Cannot start thread." << std::endl;
+    if (!m_whisper_state) {
+        std::cerr << "WhisperProcessor: Whisper state not initialized. Cannot start thread." << std::endl;
         return;
     }
     m_worker_thread = std::thread(&WhisperProcessor::processing_loop, this);
@@ -60,9 +83,48 @@ void WhisperProcessor::start_processing_thread() {
 
 void WhisperProcessor::join_thread() { if (m_worker_thread.joinable()) { m_worker_thread.join(); } }
 
-std::vector<float> WhisperProcessor::resample_audio(const std::vector<float>& input_audio) {
+size_t WhisperProcessor::push_audio(const float* samples, size_t count) {
+    return push_audio_strided(samples, count, 1);
+}
+
+size_t WhisperProcessor::push_audio_strided(const float* samples, size_t frames, size_t stride) {
+    if (!samples || frames == 0) return 0;
+    size_t written = m_input_ring.write_strided(samples, frames, stride);
+    if (written < frames) {
+        m_dropped_samples.fetch_add(frames - written, std::memory_order_relaxed);
+        m_unmarked_drops += frames - written;
+    }
+    if (m_unmarked_drops > 0) {
+        // If the mark ring is full too, the gap is placed at a later push.
+        DropMark mark{m_samples_pushed + written, m_unmarked_drops};
+        if (m_drop_marks.write(&mark, 1) == 1) m_unmarked_drops = 0;
+    }
+#if defined(VOXFORMAT_ENABLE_TRACING)
+    if (PipelineTrace::enabled() && written > 0) {
+        // The capture callback sets the ADC time of its buffer; other producers get "now".
+        uint64_t captured_us = PipelineTrace::capture_time_us();
+        CaptureMark mark{m_samples_pushed, captured_us != 0 ? captured_us : PipelineTrace::now_us()};
+        m_capture_marks.write(&mark, 1);
+    }
+#endif
+    m_samples_pushed += written;
+    m_buffer_cv.notify_one();
+    return written;
+}
+
+void WhisperProcessor::request_stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_buffer_mutex);
+        m_stop_flag.store(true, std::memory_order_release);
+    }
+    m_buffer_cv.notify_all();
+}
+
+std::vector<float> WhisperProcessor::resample_audio(const std::vector<float>& input_audio, int input_sample_rate) {
     if (input_audio.empty()) return {};
-    double ratio = static_cast<double>(WP_WHISPER_SAMPLE_RATE) / static_cast<double>(WP_INPUT_SAMPLE_RATE);
+    if (input_sample_rate == WP_WHISPER_SAMPLE_RATE) return input_audio;
+    VOX_TRACE_SCOPE("resample_audio", "audio");
+    double ratio = static_cast<double>(WP_WHISPER_SAMPLE_RATE) / static_cast<double>(input_sample_rate);
     int est_frames = static_cast<int>(static_cast<double>(input_audio.size()) * ratio) + 1;
     std::vector<float> output(est_frames);
     SRC_DATA src_data;
@@ -85,89 +147,363 @@ std::chrono::steady_clock::time_point WhisperProcessor::get_last_activity_time()
     return m_last_activity_time.load(std::memory_order_acquire);
 }
 
+ProcessorMetrics WhisperProcessor::get_metrics() const {
+    std::lock_guard<std::mutex> lock(m_metrics_mutex);
+    ProcessorMetrics snapshot = m_metrics;
+    snapshot.dropped_samples = m_dropped_samples.load(std::memory_order_relaxed);
+    // Include the period that is still running.
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_period_start_time).count();
+    double cpu = process_cpu_seconds() - m_period_start_cpu;
+    if (m_period_open) {
+        if (snapshot.idle) { snapshot.idle_seconds += elapsed; snapshot.idle_cpu_seconds += cpu; }
+        else { snapshot.active_seconds += elapsed; snapshot.active_cpu_seconds += cpu; }
+    }
+    return snapshot;
+}
+
+void WhisperProcessor::account_period(bool idle_period) {
+    // Caller holds m_metrics_mutex.
+    auto now = std::chrono::steady_clock::now();
+    double cpu_now = process_cpu_seconds();
+    double elapsed = std::chrono::duration<double>(now - m_period_start_time).count();
+    if (idle_period) {
+        m_metrics.idle_seconds += elapsed;
+        m_metrics.idle_cpu_seconds += cpu_now - m_period_start_cpu;
+    } else {
+        m_metrics.active_seconds += elapsed;
+        m_metrics.active_cpu_seconds += cpu_now - m_period_start_cpu;
+    }
+    m_period_start_time = now;
+    m_period_start_cpu = cpu_now;
+}
+
+void WhisperProcessor::consume_buffer_front(size_t count) {
+    m_audio_buffer.erase(m_audio_buffer.begin(), m_audio_buffer.begin() + static_cast<std::ptrdiff_t>(count));
+    m_buffer_stream_position += count;
+}
+
+void WhisperProcessor::record_skipped_input(size_t count) {
+    // Never decoded, but recorded so the recording holds the session's whole input.
+    if (!m_recorder || count == 0) return;
+    std::vector<float> skipped(m_audio_buffer.begin(), m_audio_buffer.begin() + static_cast<std::ptrdiff_t>(count));
+    m_recorder->record_audio(resample_audio(skipped, m_input_sample_rate));
+}
+
+uint64_t WhisperProcessor::capture_time_us(uint64_t stream_position) {
+    m_capture_marks.drain_into(m_pending_capture_marks);
+    // Interpolate between the marks around the position (producers need not push in real time);
+    // past the last mark, extrapolate by the sample rate.
+    auto next = std::upper_bound(m_pending_capture_marks.begin(), m_pending_capture_marks.end(), stream_position,
+                                 [](uint64_t pos, const CaptureMark& mark) { return pos < mark.first_sample; });
+    if (next == m_pending_capture_marks.begin()) return 0;
+    auto it = next - 1;
+    uint64_t offset = stream_position - it->first_sample;
+    uint64_t ts_us;
+    if (next != m_pending_capture_marks.end() && next->ts_us >= it->ts_us) {
+        ts_us = it->ts_us + (next->ts_us - it->ts_us) * offset / (next->first_sample - it->first_sample);
+    } else {
+        ts_us = std::min<uint64_t>(PipelineTrace::now_us(), it->ts_us + offset * 1000000ull / static_cast<uint64_t>(m_input_sample_rate));
+    }
+    // Positions only move forward, so earlier marks are no longer needed.
+    m_pending_capture_marks.erase(m_pending_capture_marks.begin(), it);
+    return ts_us;
+}
+
+uint64_t WhisperProcessor::input_time_ms(uint64_t stream_position) {
+    m_drop_marks.drain_into(m_pending_drop_marks);
+    size_t passed = 0;
+    while (passed < m_pending_drop_marks.size() && m_pending_drop_marks[passed].stream_position <= stream_position) {
+        m_dropped_before += m_pending_drop_marks[passed++].count;
+    }
+    m_pending_drop_marks.erase(m_pending_drop_marks.begin(), m_pending_drop_marks.begin() + static_cast<std::ptrdiff_t>(passed));
+    return (stream_position + m_dropped_before) * 1000 / static_cast<uint64_t>(m_input_sample_rate);
+}
+
+bool WhisperProcessor::trace_chunk_latency(uint64_t chunk_id, uint64_t first_sample, uint64_t end_sample, uint64_t dequeue_us) {
+    uint64_t first_us = capture_time_us(first_sample);
+    uint64_t last_us = std::min(capture_time_us(end_sample - 1), dequeue_us);
+    if (first_us == 0 || last_us == 0) return false;
+    // Nested on the chunk's latency track; "mic_to_commit" is closed when the text is committed.
+    PipelineTrace::async_begin("mic_to_commit", chunk_id, first_us);
+    PipelineTrace::async_begin("buffering", chunk_id, first_us);
+    PipelineTrace::async_end("buffering", chunk_id, last_us);
+    PipelineTrace::async_begin("queue_wait", chunk_id, last_us);
+    PipelineTrace::async_end("queue_wait", chunk_id, dequeue_us);
+    return true;
+}
+
+void WhisperProcessor::enter_idle() {
+    // Drop the decoder's transient buffers (KV cache, mel, logits); the model weights stay shared.
+    if (m_whisper_state) { whisper_free_state(m_whisper_state); m_whisper_state = nullptr; }
+    {
+        std::lock_guard<std::mutex> lock(m_buffer_mutex);
+        m_vad.reset();
+        m_vad_cursor = 0;
+    }
+    std::lock_guard<std::mutex> lock(m_metrics_mutex);
+    account_period(false);
+    m_metrics.idle = true;
+    ++m_metrics.idle_entries;
+}
+
+bool WhisperProcessor::wait_for_speech() {
+    const size_t preroll_samples = static_cast<size_t>(m_input_sample_rate * WP_IDLE_PREROLL_SECONDS_VAL);
+    std::chrono::steady_clock::time_point preroll_start_time;
+    {
+        std::unique_lock<std::mutex> lock(m_buffer_mutex);
+        while (true) {
+            m_buffer_cv.wait_for(lock, std::chrono::milliseconds(WP_IDLE_POLL_MILLISECONDS), [&]{
+                return m_stop_flag.load(std::memory_order_relaxed);
+            });
+            // On stop, whatever was pushed since the last poll still gets its VAD pass below.
+            const bool stopping = m_stop_flag.load(std::memory_order_relaxed);
+            m_input_ring.drain_into(m_audio_buffer);
+
+            // m_vad_cursor maps VAD stream positions to buffer indices: buffer[0] is stream
+            // position (samples_seen - m_vad_cursor).
+            uint64_t onset_sample = 0;
+            bool speech = m_vad.process(m_audio_buffer.data() + m_vad_cursor, m_audio_buffer.size() - m_vad_cursor, onset_sample);
+            uint64_t buffer_stream_start = m_vad.samples_seen() - m_audio_buffer.size();
+            m_vad_cursor = m_audio_buffer.size();
+            if (speech) {
+                size_t onset_index = onset_sample > buffer_stream_start ? static_cast<size_t>(onset_sample - buffer_stream_start) : 0;
+                size_t keep_from = onset_index > preroll_samples ? onset_index - preroll_samples : 0;
+                // The buffer's last sample was captured about now; date the pre-roll back from it.
+                auto buffered = std::chrono::duration<double>(static_cast<double>(m_audio_buffer.size() - keep_from) / m_input_sample_rate);
+                preroll_start_time = std::chrono::steady_clock::now() -
+                                     std::chrono::duration_cast<std::chrono::steady_clock::duration>(buffered);
+                record_skipped_input(keep_from);
+                consume_buffer_front(keep_from);
+                break;
+            }
+            if (stopping) return false; // only silence left
+            // Nothing but silence: keep only enough to serve as pre-roll.
+            if (m_audio_buffer.size() > preroll_samples) {
+                size_t drop = m_audio_buffer.size() - preroll_samples;
+                record_skipped_input(drop);
+                consume_buffer_front(drop);
+                m_vad_cursor = m_audio_buffer.size();
+            }
+#if defined(VOXFORMAT_ENABLE_TRACING)
+            if (PipelineTrace::enabled()) capture_time_us(m_buffer_stream_position); // keeps the mark ring drained
+#endif
+        }
+    }
+
+    // Audio keeps collecting in the input ring meanwhile, so a failed attempt loses nothing until it fills.
+    while (!(m_whisper_state = m_model->create_state())) {
+        if (m_stop_flag.load(std::memory_order_relaxed)) {
+            std::cerr << "WhisperProcessor: Could not recreate the decoder state after idle; stopping without "
+                      << "decoding the remaining audio." << std::endl;
+            return false;
+        }
+        std::cerr << "WhisperProcessor: Could not recreate the decoder state after idle; retrying in "
+                  << WP_RESUME_RETRY_MILLISECONDS << " ms." << std::endl;
+        // A stop cuts the wait short for one last attempt.
+        std::unique_lock<std::mutex> lock(m_buffer_mutex);
+        m_buffer_cv.wait_for(lock, std::chrono::milliseconds(WP_RESUME_RETRY_MILLISECONDS), [&]{
+            return m_stop_flag.load(std::memory_order_relaxed);
+        });
+    }
+    auto ready_time = std::chrono::steady_clock::now();
+    m_last_activity_time.store(ready_time);
+    double latency_ms = std::chrono::duration<double, std::milli>(ready_time - preroll_start_time).count();
+    std::lock_guard<std::mutex> lock(m_metrics_mutex);
+    account_period(true);
+    m_metrics.idle = false;
+    ++m_metrics.resumes;
+    m_metrics.last_resume_latency_ms = latency_ms;
+    m_metrics.max_resume_latency_ms = std::max(m_metrics.max_resume_latency_ms, latency_ms);
+    m_metrics.total_resume_latency_ms += latency_ms;
+    return true;
+}
+
+std::string WhisperProcessor::transcribe_chunk(const std::vector<float>& resampled_chunk, [[maybe_unused]] uint64_t chunk_id,
+                                               uint64_t window_start_ms) {
+    if (m_recorder) {
+        uint64_t first_sample = m_recorder->record_audio(resampled_chunk);
+        m_recorder->record_chunk(m_chunk_sequence, first_sample, resampled_chunk.size(), window_start_ms);
+    }
+    const auto chunk_start_time = std::chrono::steady_clock::now();
+    whisper_context* ctx = m_model->context();
+    whisper_full_params params = WhisperModel::default_decode_params(m_word_timestamps);
+    std::vector<TranscribedSegment> segments;
+    std::string cache_key;
+    if (m_transcript_cache) {
+        if (m_decoder_fingerprint.empty()) m_decoder_fingerprint = m_transcript_cache->decoder_fingerprint(m_model->path(), params);
+        VOX_TRACE_SCOPE("transcript_cache_key", "inference");
+        cache_key = m_transcript_cache->key_for(resampled_chunk, m_decoder_fingerprint);
+    }
+    auto decode = [&]() {
+#if defined(VOXFORMAT_ENABLE_TRACING)
+        if (PipelineTrace::enabled()) {
+            // whisper_full has no hook between encoder and decoder; the encoder-begin
+            // callback at least separates mel/feature preparation from the model passes.
+            PipelineTrace::set_current_chunk(chunk_id);
+            uint64_t start_us = PipelineTrace::now_us();
+            uint64_t encoder_begin_us = 0;
+            params.encoder_begin_callback = [](whisper_context*, whisper_state*, void* user_data) {
+                *static_cast<uint64_t*>(user_data) = PipelineTrace::now_us();
+                return true;
+            };
+            params.encoder_begin_callback_user_data = &encoder_begin_us;
+            int result = whisper_full_with_state(ctx, m_whisper_state, params, resampled_chunk.data(), static_cast<int>(resampled_chunk.size()));
+            uint64_t end_us = PipelineTrace::now_us();
+            PipelineTrace::span("whisper_full", "inference", start_us, end_us);
+            if (encoder_begin_us != 0) {
+                PipelineTrace::span("whisper_mel", "inference", start_us, encoder_begin_us);
+                PipelineTrace::span("whisper_encode_decode", "inference", encoder_begin_us, end_us);
+            }
+            return result;
+        }
+#endif
+        return whisper_full_with_state(ctx, m_whisper_state, params, resampled_chunk.data(), static_cast<int>(resampled_chunk.size()));
+    };
+    int stt_result;
+    const bool from_cache = !cache_key.empty() && m_transcript_cache->lookup(cache_key, segments);
+    if (from_cache) {
+        stt_result = 0;
+    } else if (m_inference_pool) {
+        // Includes the wait for a free pool worker; whisper_full itself is on the worker's track.
+        VOX_TRACE_SCOPE("inference_pool_run", "inference");
+        params.n_threads = m_inference_pool->threads_per_job();
+        stt_result = m_inference_pool->run(decode);
+    } else {
+        stt_result = decode();
+    }
+    if (stt_result == 0 && !from_cache) {
+        segments = collect_transcribed_segments(ctx, m_whisper_state, m_word_timestamps);
+        if (!cache_key.empty()) m_transcript_cache->store(cache_key, segments);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_metrics_mutex);
+        ++m_metrics.chunks_processed;
+    }
+
+    bool committed = false;
+    std::string current_chunk_text_combined = "";
+    if (stt_result == 0) {
+        for (const auto& transcribed : segments) {
+            const std::string& segment = transcribed.text;
+            if(!current_chunk_text_combined.empty() && !segment.empty() && segment.front() != ' ' && current_chunk_text_combined.back() != ' ') {
+                 current_chunk_text_combined += " ";
+            }
+            current_chunk_text_combined += segment;
+        }
+        {
+            VOX_TRACE_SCOPE("cleanup_stt_artifacts", "text");
+            current_chunk_text_combined = cleanup_stt_artifacts_util(current_chunk_text_combined);
+        }
+        if (m_transcript_callback && !current_chunk_text_combined.empty()) {
+            m_transcript_callback(current_chunk_text_combined, false);
+        }
+
+        if (m_first_transcription_run || (m_previous_chunk_full_text_for_dedup != current_chunk_text_combined && !current_chunk_text_combined.empty())) {
+            if (m_first_transcription_run && !current_chunk_text_combined.empty()) {
+                 m_formatter_ref.clear_document();
+                 m_first_transcription_run = false;
+            }
+            if (!current_chunk_text_combined.empty()) {
+                m_formatter_ref.process_transcribed_text(current_chunk_text_combined, spoken_words(segments, window_start_ms));
+                if (m_transcript_callback) m_transcript_callback(current_chunk_text_combined, true);
+                m_last_activity_time.store(std::chrono::steady_clock::now());
+                committed = true;
+            }
+        }
+        m_previous_chunk_full_text_for_dedup = current_chunk_text_combined;
+    }
+    if (m_recorder) m_recorder->record_transcript(m_chunk_sequence, current_chunk_text_combined, committed);
+    double chunk_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - chunk_start_time).count();
+    {
+        std::lock_guard<std::mutex> lock(m_metrics_mutex);
+        m_metrics.total_chunk_seconds += chunk_seconds;
+        m_metrics.max_chunk_seconds = std::max(m_metrics.max_chunk_seconds, chunk_seconds);
+    }
+    return current_chunk_text_combined;
+}
+
+std::string WhisperProcessor::replay_chunk(const std::vector<float>& samples_16k, uint64_t window_start_ms) {
+    const uint64_t chunk_id = (m_trace_stream_id << 32) | ++m_chunk_sequence;
+#if defined(VOXFORMAT_ENABLE_TRACING)
+    if (PipelineTrace::enabled()) PipelineTrace::set_current_chunk(chunk_id);
+#endif
+    return transcribe_chunk(samples_16k, chunk_id, window_start_ms);
+}
+
 void WhisperProcessor::processing_loop() {
     std::vector<float> chunk_to_process_raw;
+#if defined(VOXFORMAT_ENABLE_TRACING)
+    PipelineTrace::set_thread_name("whisper-worker");
+#endif
+    {
+        std::lock_guard<std::mutex> lock(m_metrics_mutex);
+        m_period_start_time = std::chrono::steady_clock::now();
+        m_period_start_cpu = process_cpu_seconds();
+        m_period_open = true;
+    }
+
+    while (true) {
+        if (m_idle_after.count() > 0 && !m_stop_flag.load(std::memory_order_relaxed) &&
+            std::chrono::steady_clock::now() - m_last_activity_time.load(std::memory_order_acquire) >= m_idle_after) {
+            enter_idle();
+            chunk_to_process_raw.clear();
+            chunk_to_process_raw.shrink_to_fit();
+            if (!wait_for_speech()) break;
+        }
 
-    while (!m_stop_flag_ref.load(std::memory_order_relaxed)) {
         chunk_to_process_raw.clear();
+        bool final_chunk = false;
+        uint64_t chunk_first_sample = 0;
         {
-            std::unique_lock<std::mutex> lock(m_buffer_mutex_ref);
-            m_buffer_cv_ref.wait_for(lock, std::chrono::milliseconds(200), [&]{
-                return (m_shared_audio_buffer_ref.size() >= WP_CHUNK_PROCESSING_SAMPLES_RAW) ||
-                       m_stop_flag_ref.load(std::memory_order_relaxed);
+            std::unique_lock<std::mutex> lock(m_buffer_mutex);
+            m_buffer_cv.wait_for(lock, std::chrono::milliseconds(200), [&]{
+                return (m_audio_buffer.size() + m_input_ring.size() >= m_chunk_processing_samples) ||
+                       m_stop_flag.load(std::memory_order_relaxed);
             });
+            m_input_ring.drain_into(m_audio_buffer);
 
-            if (m_stop_flag_ref.load(std::memory_order_relaxed)) {
-                if (m_shared_audio_buffer_ref.size() >= WP_MIN_SAMPLES_FOR_FINAL_CHUNK_RAW) {
-                    chunk_to_process_raw.assign(m_shared_audio_buffer_ref.begin(), m_shared_audio_buffer_ref.end());
-                    m_shared_audio_buffer_ref.clear();
+            chunk_first_sample = m_buffer_stream_position;
+            if (m_audio_buffer.size() >= m_chunk_processing_samples) {
+                chunk_to_process_raw.assign(m_audio_buffer.begin(), m_audio_buffer.begin() + m_chunk_processing_samples);
+                consume_buffer_front(m_chunk_processing_samples);
+            } else if (m_stop_flag.load(std::memory_order_relaxed)) {
+                if (m_audio_buffer.size() >= m_min_samples_for_final_chunk) {
+                    chunk_to_process_raw.swap(m_audio_buffer);
+                    m_buffer_stream_position += chunk_to_process_raw.size();
+                    m_audio_buffer.clear();
+                    final_chunk = true;
                 } else {
                     break;
                 }
-            } else if (m_shared_audio_buffer_ref.size() >= WP_CHUNK_PROCESSING_SAMPLES_RAW) {
-                chunk_to_process_raw.assign(m_shared_audio_buffer_ref.begin(), m_shared_audio_buffer_ref.begin() + WP_CHUNK_PROCESSING_SAMPLES_RAW);
-                m_shared_audio_buffer_ref.erase(m_shared_audio_buffer_ref.begin(), m_shared_audio_buffer_ref.begin() + WP_CHUNK_PROCESSING_SAMPLES_RAW);
             } else {
                 continue;
             }
         }
 
-        if (chunk_to_process_raw.empty()) {
-             if (m_stop_flag_ref.load(std::memory_order_relaxed)) break;
-            continue;
+        [[maybe_unused]] const uint64_t chunk_id = (m_trace_stream_id << 32) | ++m_chunk_sequence;
+        [[maybe_unused]] bool latency_traced = false;
+#if defined(VOXFORMAT_ENABLE_TRACING)
+        if (PipelineTrace::enabled()) {
+            PipelineTrace::set_current_chunk(chunk_id);
+            latency_traced = trace_chunk_latency(chunk_id, chunk_first_sample, chunk_first_sample + chunk_to_process_raw.size(), PipelineTrace::now_us());
         }
+#endif
 
-        m_last_activity_time.store(std::chrono::steady_clock::now());
-        std::vector<float> resampled_chunk = resample_audio(chunk_to_process_raw);
-        if (resampled_chunk.empty()) continue;
-
-        whisper_full_params params = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
-        params.language         = "en";
-        params.suppress_blank   = true;
-        params.print_realtime   = false;
-        params.print_progress   = false;
-        params.no_timestamps    = true;
-
-        int stt_result = whisper_full(m_whisper_ctx, params, resampled_chunk.data(), resampled_chunk.size());
-
-        if (stt_result == 0) {
-            int n_segments = whisper_full_n_segments(m_whisper_ctx);
-            std::string current_chunk_text_combined = "";
-            bool new_text_this_run = false;
-
-            if (n_segments > 0) {
-                for (int i = 0; i < n_segments; ++i) {
-                    const char* text_cstr = whisper_full_get_segment_text(m_whisper_ctx, i);
-                    if (text_cstr) {
-                        std::string segment = std::string(text_cstr);
-                        if(!current_chunk_text_combined.empty() && !segment.empty() && segment.front() != ' ' && current_chunk_text_combined.back() != ' ') {
-                             current_chunk_text_combined += " ";
-                        }
-                        current_chunk_text_combined += segment;
-                    }
-                }
-            }
-            current_chunk_text_combined = cleanup_stt_artifacts_util(current_chunk_text_combined);
-
-            if (m_first_transcription_run || (m_previous_chunk_full_text_for_dedup != current_chunk_text_combined && !current_chunk_text_combined.empty())) {
-                if (m_first_transcription_run && !current_chunk_text_combined.empty()) {
-                     m_formatter_ref.clear_document();
-                     m_first_transcription_run = false;
-                }
-                if (!current_chunk_text_combined.empty()) {
-                    m_formatter_ref.process_transcribed_text(current_chunk_text_combined);
-                    new_text_this_run = true;
-                    m_last_activity_time.store(std::chrono::steady_clock::now());
-                }
-            }
-            m_previous_chunk_full_text_for_dedup = current_chunk_text_combined;
-
-            if (new_text_this_run) {
-                m_formatter_ref.print_current_document_preview();
-            }
+        std::vector<float> resampled_chunk = resample_audio(chunk_to_process_raw, m_input_sample_rate);
+        if (!resampled_chunk.empty()) {
+            transcribe_chunk(resampled_chunk, chunk_id, input_time_ms(chunk_first_sample));
         }
-        if (m_stop_flag_ref.load(std::memory_order_relaxed) && m_shared_audio_buffer_ref.empty() ) {
+#if defined(VOXFORMAT_ENABLE_TRACING)
+        // Ends at the commit, or where the chunk was found to add nothing.
+        if (latency_traced) PipelineTrace::async_end("mic_to_commit", chunk_id, PipelineTrace::now_us());
+#endif
+        if (final_chunk) {
             break;
         }
     }
-}
\ No newline at end of file
+
+    std::lock_guard<std::mutex> lock(m_metrics_mutex);
+    account_period(m_metrics.idle);
+    m_period_open = false;
+}
@@ -8,8 +8,17 @@
 #include <condition_variable>
 #include <atomic>
 #include <chrono>
+#include <functional>
+#include <memory>
 #include "whisper.h"
+#include "whisper_model.h"
 #include "document_formatter.h"
+#include "energy_vad.h"
+#include "spsc_ring_buffer.h"
+#include "inference_pool.h"
+#include "pipeline_trace.h"
+#include "session_recorder.h"
+#include "transcript_cache.h"
 
 // Define constants used by this class and potentially by main.cpp for printing
 // These are now preprocessor macros for easier use in calculating other constants within this header.
@@ -18,21 +27,42 @@
 #define WP_WHISPER_SAMPLE_RATE 16000
 #define WP_WINDOW_SLIDE_SECONDS_VAL 2.0
 #define WP_MIN_CHUNK_PROCESS_SECONDS_VAL 1.0 // For final chunk
+#define WP_IDLE_PREROLL_SECONDS_VAL 0.5      // audio kept ahead of detected speech when waking from idle
+#define WP_IDLE_POLL_MILLISECONDS 100
+#define WP_RESUME_RETRY_MILLISECONDS 1000   // between attempts to recreate the decoder state on wake-up
+#define WP_INPUT_RING_SECONDS_VAL 30.0       // input the worker may fall behind by before samples are dropped
+#define WP_CAPTURE_MARK_CAPACITY 8192        // capture timestamps kept for tracing (one per pushed buffer)
+#define WP_DROP_MARK_CAPACITY 1024           // input overflows the worker has not yet put on its timeline
 
-// Calculated constants
-const size_t WP_CHUNK_PROCESSING_SAMPLES_RAW = static_cast<size_t>(WP_INPUT_SAMPLE_RATE * WP_PROCESSING_WINDOW_SECONDS_VAL);
-const size_t WP_WINDOW_SLIDE_SAMPLES_RAW = static_cast<size_t>(WP_INPUT_SAMPLE_RATE * WP_WINDOW_SLIDE_SECONDS_VAL);
-const size_t WP_MIN_SAMPLES_FOR_FINAL_CHUNK_RAW = static_cast<size_t>(WP_INPUT_SAMPLE_RATE * WP_MIN_CHUNK_PROCESS_SECONDS_VAL);
+struct ProcessorMetrics {
+    uint64_t chunks_processed = 0;
+    uint64_t dropped_samples = 0;      // input lost because the worker fell too far behind
+    uint64_t idle_entries = 0;
+    uint64_t resumes = 0;
+    double idle_seconds = 0.0;         // wall time spent idle
+    double idle_cpu_seconds = 0.0;     // process CPU time consumed while idle
+    double active_seconds = 0.0;
+    double active_cpu_seconds = 0.0;
+    double last_resume_latency_ms = 0.0; // capture of the first pre-roll sample -> decoder ready
+    double max_resume_latency_ms = 0.0;
+    double total_resume_latency_ms = 0.0;
+    double total_chunk_seconds = 0.0;  // decode (or cache lookup) through commit, per chunk
+    double max_chunk_seconds = 0.0;
+    bool idle = false;
+};
 
 
+// Turns pushed PCM into formatted document text. Owns its input buffer and worker thread;
+// the only shared piece is the (read-only) model, so any number can run side by side.
 class WhisperProcessor {
 public:
-    WhisperProcessor(const std::string& model_path,
-                       std::vector<float>& shared_audio_buffer,
-                       std::mutex& buffer_mutex,
-                       std::condition_variable& buffer_cv,
-                       std::atomic<bool>& stop_flag,
-                       DocumentFormatter& formatter);
+    // is_final == false: decoded text of one window before de-duplication.
+    // is_final == true: text that was committed to the document.
+    using TranscriptCallback = std::function<void(const std::string& text, bool is_final)>;
+
+    WhisperProcessor(std::shared_ptr<WhisperModel> model,
+                     DocumentFormatter& formatter,
+                     int input_sample_rate = WP_INPUT_SAMPLE_RATE);
     ~WhisperProcessor();
 
     bool initialize_whisper();
@@ -41,23 +71,108 @@ public:
     bool is_thread_joinable() const;
     std::chrono::steady_clock::time_point get_last_activity_time() const; // Declaration added
 
+    // Producer side is lock-free and allocation-free; call it from one thread only (e.g. the
+    // audio callback). Returns how many samples were accepted.
+    size_t push_audio(const float* samples, size_t count);
+    // Takes every stride-th sample, i.e. one channel of an interleaved multichannel buffer.
+    size_t push_audio_strided(const float* samples, size_t frames, size_t stride);
+    // Asks the worker to process what is buffered (if long enough) and exit.
+    void request_stop();
+    bool stop_requested() const { return m_stop_flag.load(std::memory_order_acquire); }
+    // Must be set before start_processing_thread().
+    void set_transcript_callback(TranscriptCallback callback) { m_transcript_callback = std::move(callback); }
+
+    // After this long without committed text the worker frees its decoder state and only
+    // runs an energy VAD over the input until speech returns. Zero disables idle mode.
+    // Must be set before start_processing_thread().
+    void set_idle_timeout(std::chrono::milliseconds idle_after) { m_idle_after = idle_after; }
+    // Run decodes on a shared pool instead of this processor's own thread. Set before starting.
+    void set_inference_pool(std::shared_ptr<InferencePool> pool) { m_inference_pool = std::move(pool); }
+    // Stream every decoded chunk and its transcript to a recording. Set before starting.
+    void set_session_recorder(std::shared_ptr<SessionRecorder> recorder) { m_recorder = std::move(recorder); }
+    // Decode with token timestamps so committed words carry their audio time (for the word index).
+    // Set before starting.
+    void set_word_timestamps(bool enabled) { m_word_timestamps = enabled; }
+    // Reuse decoder output for windows decoded before (by any process sharing the cache). Set before starting.
+    void set_transcript_cache(std::shared_ptr<TranscriptCache> cache) { m_transcript_cache = std::move(cache); }
+    ProcessorMetrics get_metrics() const;
+
+    // Replay: decodes and commits one chunk that is already at 16 kHz on the calling thread,
+    // exactly as the worker would. window_start_ms is where the live window started in the
+    // session's input. Returns the decoded text. Only while the worker is not running.
+    std::string replay_chunk(const std::vector<float>& samples_16k, uint64_t window_start_ms);
+
+    // Converts mono audio at input_sample_rate to the 16 kHz whisper expects.
+    static std::vector<float> resample_audio(const std::vector<float>& input_audio, int input_sample_rate);
+
 private:
     void processing_loop();
-    std::vector<float> resample_audio(const std::vector<float>& input_audio);
+    // Decode, de-duplicate and commit; returns the decoded (cleaned) text. window_start_ms places
+    // the chunk's word timings on the session's audio timeline.
+    std::string transcribe_chunk(const std::vector<float>& resampled_chunk, uint64_t chunk_id, uint64_t window_start_ms);
+    void enter_idle();
+    // Also returns once stop is requested, so the audio still pushed gets decoded. False if
+    // there is nothing left worth decoding or the decoder state cannot be recreated.
+    bool wait_for_speech();
+    void account_period(bool idle_period);
+    void consume_buffer_front(size_t count);
+    void record_skipped_input(size_t count); // the front of m_audio_buffer, before it is dropped
+    // Trace clock time at which the given input stream sample was captured.
+    uint64_t capture_time_us(uint64_t stream_position);
+    // Where the given input stream sample sits in the session's input, counting what was dropped
+    // before it. Positions must not move backwards.
+    uint64_t input_time_ms(uint64_t stream_position);
+    // Returns whether "mic_to_commit" was begun; false if the capture times are unknown.
+    bool trace_chunk_latency(uint64_t chunk_id, uint64_t first_sample, uint64_t end_sample, uint64_t dequeue_us);
 
-    std::string m_model_path;
-    whisper_context* m_whisper_ctx;
+    std::shared_ptr<WhisperModel> m_model;
+    whisper_state* m_whisper_state;
     std::thread m_worker_thread;
+    int m_input_sample_rate;
+    size_t m_chunk_processing_samples;
+    size_t m_min_samples_for_final_chunk;
 
-    std::vector<float>& m_shared_audio_buffer_ref;
-    std::mutex& m_buffer_mutex_ref;
-    std::condition_variable& m_buffer_cv_ref;
-    std::atomic<bool>& m_stop_flag_ref;
+    SpscRingBuffer<float> m_input_ring;
+    std::atomic<uint64_t> m_dropped_samples{0};
+    std::vector<float> m_audio_buffer; // worker-private, filled from m_input_ring
+    uint64_t m_buffer_stream_position = 0; // input stream index of m_audio_buffer[0]
+
+    // Tracing: the producer notes when each pushed buffer was captured, keyed by stream position.
+    struct CaptureMark { uint64_t first_sample; uint64_t ts_us; };
+    SpscRingBuffer<CaptureMark> m_capture_marks;
+    std::vector<CaptureMark> m_pending_capture_marks; // worker-private
+    uint64_t m_samples_pushed = 0;                    // producer-private
+    // Input dropped on a full ring leaves a gap in capture time just before stream_position.
+    struct DropMark { uint64_t stream_position; uint64_t count; };
+    SpscRingBuffer<DropMark> m_drop_marks;
+    uint64_t m_unmarked_drops = 0;               // producer-private: not yet in m_drop_marks
+    std::vector<DropMark> m_pending_drop_marks;  // worker-private
+    uint64_t m_dropped_before = 0;               // worker-private: dropped ahead of the last position asked
+    uint64_t m_trace_stream_id;
+    uint64_t m_chunk_sequence = 0;
+    std::mutex m_buffer_mutex;         // only guards the wake-up wait and stop flag
+    std::shared_ptr<InferencePool> m_inference_pool;
+    std::shared_ptr<SessionRecorder> m_recorder;
+    std::shared_ptr<TranscriptCache> m_transcript_cache;
+    bool m_word_timestamps = false;
+    std::string m_decoder_fingerprint; // worker-private, computed on first use
+    std::condition_variable m_buffer_cv;
+    std::atomic<bool> m_stop_flag{false};
     DocumentFormatter& m_formatter_ref;
+    TranscriptCallback m_transcript_callback;
+
+    std::chrono::milliseconds m_idle_after{0};
+    EnergyVad m_vad;
+    size_t m_vad_cursor = 0; // buffer index the VAD has consumed up to (idle only)
+    mutable std::mutex m_metrics_mutex;
+    ProcessorMetrics m_metrics;
+    std::chrono::steady_clock::time_point m_period_start_time;
+    double m_period_start_cpu = 0.0;
+    bool m_period_open = false; // worker running, so the current period counts in snapshots
 
     bool m_first_transcription_run;
     std::string m_previous_chunk_full_text_for_dedup;
     std::atomic<std::chrono::steady_clock::time_point> m_last_activity_time;
 };
 
-#endif // WHISPER_PROCESSOR_H
\ No newline at end of file
+#endif // WHISPER_PROCESSOR_H
@@ -0,0 +1,177 @@
+#include "word_index.h"
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <numeric>
+#include <cstring>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr size_t kHeaderBytes = 8 + 4 + 4 + 8;
+constexpr size_t kEntryBytes = 16;
+
+void put_u32(std::string& out, uint32_t v) {
+    for (int i = 0; i < 4; ++i) out.push_back(static_cast<char>((v >> (8 * i)) & 0xff));
+}
+
+void put_u64(std::string& out, uint64_t v) {
+    for (int i = 0; i < 8; ++i) out.push_back(static_cast<char>((v >> (8 * i)) & 0xff));
+}
+
+uint32_t get_u32(const unsigned char* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+uint64_t get_u64(const unsigned char* p) {
+    return static_cast<uint64_t>(get_u32(p)) | (static_cast<uint64_t>(get_u32(p + 4)) << 32);
+}
+
+} // namespace
+
+bool write_word_index(const std::string& path, const std::vector<WordIndexEntry>& entries, uint64_t document_bytes) {
+    // Token timestamps are not strictly monotonic across a document, so time gets its own ordering.
+    std::vector<uint32_t> by_time(entries.size());
+    std::iota(by_time.begin(), by_time.end(), 0u);
+    std::stable_sort(by_time.begin(), by_time.end(), [&](uint32_t a, uint32_t b) {
+        return entries[a].start_ms < entries[b].start_ms;
+    });
+
+    std::string buffer(WI_FILE_MAGIC);
+    buffer.reserve(kHeaderBytes + entries.size() * (kEntryBytes + 4));
+    put_u32(buffer, static_cast<uint32_t>(entries.size()));
+    put_u32(buffer, 0);
+    put_u64(buffer, document_bytes);
+    for (const WordIndexEntry& entry : entries) {
+        put_u32(buffer, entry.text_offset);
+        put_u32(buffer, entry.text_length);
+        put_u32(buffer, entry.start_ms);
+        put_u32(buffer, entry.end_ms);
+    }
+    for (uint32_t word : by_time) put_u32(buffer, word);
+
+    std::string temp_path = path + ".tmp";
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        if (!out.is_open() || !out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()))) {
+            std::cerr << "WordIndex: Could not write " << temp_path << std::endl;
+            return false;
+        }
+    }
+    std::error_code ec;
+    fs::rename(temp_path, path, ec);
+    if (ec) {
+        std::cerr << "WordIndex: Could not replace " << path << ": " << ec.message() << std::endl;
+        fs::remove(temp_path, ec);
+        return false;
+    }
+    return true;
+}
+
+WordIndexReader::~WordIndexReader() {
+    close();
+}
+
+void WordIndexReader::close() {
+#if defined(_WIN32)
+    if (m_data) UnmapViewOfFile(m_data);
+    if (m_mapping_handle) CloseHandle(m_mapping_handle);
+    if (m_file_handle) CloseHandle(m_file_handle);
+    m_mapping_handle = nullptr;
+    m_file_handle = nullptr;
+#else
+    if (m_data) munmap(const_cast<unsigned char*>(m_data), m_mapped_bytes);
+#endif
+    m_data = nullptr;
+    m_mapped_bytes = 0;
+    m_count = 0;
+}
+
+bool WordIndexReader::open(const std::string& path) {
+    close();
+    std::error_code ec;
+    uint64_t file_bytes = fs::file_size(path, ec);
+    if (ec) {
+        std::cerr << "WordIndexReader: Could not open " << path << std::endl;
+        return false;
+    }
+    if (file_bytes < kHeaderBytes) {
+        std::cerr << "WordIndexReader: " << path << " is not a voxformat word index." << std::endl;
+        return false;
+    }
+    m_mapped_bytes = static_cast<size_t>(file_bytes);
+#if defined(_WIN32)
+    m_file_handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_file_handle == INVALID_HANDLE_VALUE) m_file_handle = nullptr;
+    if (m_file_handle) m_mapping_handle = CreateFileMappingA(m_file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_mapping_handle) m_data = static_cast<const unsigned char*>(MapViewOfFile(m_mapping_handle, FILE_MAP_READ, 0, 0, 0));
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        void* mapped = mmap(nullptr, m_mapped_bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapped != MAP_FAILED) m_data = static_cast<const unsigned char*>(mapped);
+    }
+#endif
+    if (!m_data) {
+        std::cerr << "WordIndexReader: Could not map " << path << std::endl;
+        close();
+        return false;
+    }
+    uint64_t count = get_u32(m_data + 8);
+    if (std::memcmp(m_data, WI_FILE_MAGIC, 8) != 0 || kHeaderBytes + count * (kEntryBytes + 4) != file_bytes) {
+        std::cerr << "WordIndexReader: " << path << " is not a voxformat word index or is truncated." << std::endl;
+        close();
+        return false;
+    }
+    m_count = static_cast<size_t>(count);
+    m_document_bytes = get_u64(m_data + 16);
+    return true;
+}
+
+WordIndexEntry WordIndexReader::entry(size_t word) const {
+    const unsigned char* p = m_data + kHeaderBytes + word * kEntryBytes;
+    WordIndexEntry entry;
+    entry.text_offset = get_u32(p);
+    entry.text_length = get_u32(p + 4);
+    entry.start_ms = get_u32(p + 8);
+    entry.end_ms = get_u32(p + 12);
+    return entry;
+}
+
+size_t WordIndexReader::word_at_time_rank(size_t rank) const {
+    return get_u32(m_data + kHeaderBytes + m_count * kEntryBytes + rank * 4);
+}
+
+size_t WordIndexReader::find_by_offset(uint64_t text_offset) const {
+    // First word starting after text_offset; the one before it is the answer.
+    size_t lo = 0, hi = m_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (entry(mid).text_offset <= text_offset) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo == 0 ? npos : lo - 1;
+}
+
+size_t WordIndexReader::find_by_time(uint32_t time_ms) const {
+    size_t lo = 0, hi = m_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (entry(word_at_time_rank(mid)).start_ms <= time_ms) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo == 0 ? npos : word_at_time_rank(lo - 1);
+}
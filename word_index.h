@@ -0,0 +1,62 @@
+#ifndef WORD_INDEX_H
+#define WORD_INDEX_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// Sidecar index mapping words of a saved document to audio time (<document>.idx).
+// Layout (all integers little-endian):
+//   header:  "VOXIDX01", u32 word count, u32 reserved, u64 size of the document it indexes
+//   words:   u32 text offset, u32 text length, u32 start ms, u32 end ms; sorted by text offset
+//   by time: u32 word number per word, sorted by (start ms, text offset)
+// Both tables are fixed-size records, so a reader binary-searches the mapped file in place.
+#define WI_FILE_MAGIC "VOXIDX01"
+#define WI_FILE_SUFFIX ".idx"
+
+struct WordIndexEntry {
+    uint32_t text_offset = 0; // byte offset in the document
+    uint32_t text_length = 0;
+    uint32_t start_ms = 0;
+    uint32_t end_ms = 0;
+};
+
+// Writes entries (sorted by text offset) to a temporary file and renames it over path.
+bool write_word_index(const std::string& path, const std::vector<WordIndexEntry>& entries, uint64_t document_bytes);
+
+// Memory-maps an index; lookups touch O(log n) pages and never load the whole file.
+class WordIndexReader {
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    WordIndexReader() = default;
+    ~WordIndexReader();
+    WordIndexReader(const WordIndexReader&) = delete;
+    WordIndexReader& operator=(const WordIndexReader&) = delete;
+
+    bool open(const std::string& path); // reports problems on std::cerr
+
+    size_t size() const { return m_count; }
+    uint64_t document_bytes() const { return m_document_bytes; }
+    WordIndexEntry entry(size_t word) const;
+    // The word containing text_offset, else the last word before it; npos if there is none.
+    size_t find_by_offset(uint64_t text_offset) const;
+    // The word being spoken at time_ms, else the last word started before it; npos if there is none.
+    size_t find_by_time(uint32_t time_ms) const;
+
+private:
+    void close();
+    size_t word_at_time_rank(size_t rank) const;
+
+    const unsigned char* m_data = nullptr;
+    size_t m_mapped_bytes = 0;
+    size_t m_count = 0;
+    uint64_t m_document_bytes = 0;
+#if defined(_WIN32)
+    void* m_file_handle = nullptr;
+    void* m_mapping_handle = nullptr;
+#endif
+};
+
+#endif // WORD_INDEX_H